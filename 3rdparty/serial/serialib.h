@@ -176,6 +176,11 @@ public:
     // Return the number of bytes in the received buffer
     int     available();
 
+#if defined (__linux__) || defined(__APPLE__)
+    // Underlying file descriptor, for callers that poll() the device
+    int     getFileDescriptor() const { return fd; }
+#endif
+
 
 
 
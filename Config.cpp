@@ -1,34 +1,416 @@
 #include "Config.h"
-#include <QFile>           
-#include <QJsonDocument>   
-#include <QDebug>          
+#include "3rdparty/rapidjson/filereadstream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <vector>
 
 // Singleton: Return the single instance of the Config class
 Config& Config::getInstance() {
-    static Config instance;  
+    static Config instance;
     return instance;
 }
 
 Config::Config() {
-    configObject = readConfigFile("../config.json");  
+    // Probe the usual locations once with stat instead of fopen-and-parse
+    struct stat st{};
+    for (const char* candidate : {"../config.json", "./config.json"}) {
+        if (stat(candidate, &st) == 0) {
+            configPath = candidate;
+            break;
+        }
+    }
+
+    if (configPath.empty()) {
+        std::cerr << "Could not open config file, falling back to defaults" << std::endl;
+        configObject.SetObject();
+        parsed = true;
+        snap = std::make_shared<const Settings>(cached);
+        return;
+    }
+
+    // Warm boot: a valid binary cache hands us the typed snapshot without
+    // touching rapidjson. The JSON is still parsed lazily if some caller
+    // asks for a key outside Settings.
+    std::string cachePath = configPath + ".cache";
+    if (!loadSettingsCache(cachePath)) {
+        ensureParsed();
+        cacheSettings();
+        writeSettingsCache(cachePath, cached);
+    }
+    snap = std::make_shared<const Settings>(cached);
+}
+
+Config::~Config() {
+    stopWatcher();
+}
+
+// Typed readers against an arbitrary parsed document, so the reload path
+// can work on a local parse without touching the shared configObject
+static int docInt(const rapidjson::Document& doc, const char* key, int def) {
+    auto it = doc.FindMember(key);
+    return (it != doc.MemberEnd() && it->value.IsInt()) ? it->value.GetInt() : def;
+}
+
+static std::string docString(const rapidjson::Document& doc, const char* key, const std::string& def) {
+    auto it = doc.FindMember(key);
+    return (it != doc.MemberEnd() && it->value.IsString()) ? it->value.GetString() : def;
+}
+
+static bool docBool(const rapidjson::Document& doc, const char* key, bool def) {
+    auto it = doc.FindMember(key);
+    return (it != doc.MemberEnd() && it->value.IsBool()) ? it->value.GetBool() : def;
+}
+
+void Config::readSettings(const rapidjson::Document& doc, Settings& s) {
+    s.sqlServerUrl = docString(doc, "sql_server_url", s.sqlServerUrl);
+    s.sqlTransferTimeout = docInt(doc, "sql_transfer_timeout", s.sqlTransferTimeout);
+    s.sqlRetryInterval = docInt(doc, "sql_retry_interval", s.sqlRetryInterval);
+    s.sqlBatchFrames = docInt(doc, "sql_batch_frames", s.sqlBatchFrames);
+    s.sqlBatchWindowMs = docInt(doc, "sql_batch_window_ms", s.sqlBatchWindowMs);
+    s.uplinkMode = docString(doc, "uplink_mode", s.uplinkMode);
+    s.uplinkPort = docInt(doc, "uplink_port", s.uplinkPort);
+    s.tcpServerIp = docString(doc, "tcp_server_ip", s.tcpServerIp);
+    s.tcpPort = docInt(doc, "tcp_port", s.tcpPort);
+    s.udpChasecarIp = docString(doc, "udp_chasecar_ip", s.udpChasecarIp);
+    s.udpChasecarPort = docInt(doc, "udp_chasecar_port", s.udpChasecarPort);
+    s.udpDeltaMode = docBool(doc, "udp_delta_mode", s.udpDeltaMode);
+    s.udpKeyframeInterval = docInt(doc, "udp_keyframe_interval", s.udpKeyframeInterval);
+    s.udpFramingV2 = docBool(doc, "udp_framing_v2", s.udpFramingV2);
+    s.udpMulticastGroup = docString(doc, "udp_multicast_group", s.udpMulticastGroup);
+    s.udpMulticastTtl = docInt(doc, "udp_multicast_ttl", s.udpMulticastTtl);
+    s.udpMulticastInterface = docString(doc, "udp_multicast_interface", s.udpMulticastInterface);
+    s.frameCompression = docBool(doc, "frame_compression", s.frameCompression);
+    s.ethernetPort = docInt(doc, "EthernetPort", s.ethernetPort);
+    s.fileSyncScanIntervalMs = docInt(doc, "file_sync_scan_interval", s.fileSyncScanIntervalMs);
+    s.metricsPort = docInt(doc, "metrics_port", s.metricsPort);
+    s.fetchCpu = docInt(doc, "fetch_cpu", s.fetchCpu);
+    s.fetchRtPriority = docInt(doc, "fetch_rt_priority", s.fetchRtPriority);
+    s.backendCpu = docInt(doc, "backend_cpu", s.backendCpu);
+    s.backendRtPriority = docInt(doc, "backend_rt_priority", s.backendRtPriority);
+    s.raceMode = docBool(doc, "race_mode", s.raceMode);
+}
+
+// Parse every setting into the typed snapshot once; defaults come from the
+// Settings initializers
+void Config::cacheSettings() {
+    readSettings(configObject, cached);
+}
+
+// ---- binary settings cache ------------------------------------------------
+// Layout: "BCFG" magic, uint32 version, int64 mtime sec, int64 mtime nsec,
+// uint64 file size, then the Settings fields in cacheSettings() order
+// (int32 / uint8 bool / uint32-length-prefixed string). Host byte order -
+// the cache never leaves this machine.
+
+static void putI32(std::vector<uint8_t>& out, int32_t v) {
+    out.insert(out.end(), (uint8_t*)&v, (uint8_t*)&v + sizeof(v));
+}
+
+static void putStr(std::vector<uint8_t>& out, const std::string& s) {
+    putI32(out, (int32_t)s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+static bool getI32(const std::vector<uint8_t>& in, size_t& pos, int32_t& v) {
+    if (pos + sizeof(v) > in.size()) return false;
+    memcpy(&v, in.data() + pos, sizeof(v));
+    pos += sizeof(v);
+    return true;
+}
+
+static bool getStr(const std::vector<uint8_t>& in, size_t& pos, std::string& s) {
+    int32_t len;
+    if (!getI32(in, pos, len) || len < 0 || pos + (size_t)len > in.size()) return false;
+    s.assign((const char*)in.data() + pos, (size_t)len);
+    pos += (size_t)len;
+    return true;
+}
+
+bool Config::loadSettingsCache(const std::string& cachePath) {
+    struct stat src{};
+    if (stat(configPath.c_str(), &src) != 0) {
+        return false;
+    }
+
+    FILE* fp = fopen(cachePath.c_str(), "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+    std::vector<uint8_t> blob(4096);
+    size_t n = fread(blob.data(), 1, blob.size(), fp);
+    fclose(fp);
+    blob.resize(n);
+
+    size_t pos = 0;
+    if (blob.size() < 4 || memcmp(blob.data(), "BCFG", 4) != 0) {
+        return false;
+    }
+    pos = 4;
+
+    int32_t version;
+    if (!getI32(blob, pos, version) || (uint32_t)version != CACHE_VERSION) {
+        return false;
+    }
+    int64_t mtimeSec, mtimeNsec, size;
+    if (pos + 3 * sizeof(int64_t) > blob.size()) {
+        return false;
+    }
+    memcpy(&mtimeSec, blob.data() + pos, sizeof(int64_t)); pos += sizeof(int64_t);
+    memcpy(&mtimeNsec, blob.data() + pos, sizeof(int64_t)); pos += sizeof(int64_t);
+    memcpy(&size, blob.data() + pos, sizeof(int64_t)); pos += sizeof(int64_t);
+    if (mtimeSec != (int64_t)src.st_mtim.tv_sec || mtimeNsec != (int64_t)src.st_mtim.tv_nsec ||
+        size != (int64_t)src.st_size) {
+        return false; // config.json changed since the cache was written
+    }
+
+    Settings s;
+    int32_t boolByte;
+    int32_t framingByte;
+    int32_t compressByte;
+    int32_t raceByte;
+    bool ok = getStr(blob, pos, s.sqlServerUrl)
+           && getI32(blob, pos, s.sqlTransferTimeout)
+           && getI32(blob, pos, s.sqlRetryInterval)
+           && getI32(blob, pos, s.sqlBatchFrames)
+           && getI32(blob, pos, s.sqlBatchWindowMs)
+           && getStr(blob, pos, s.uplinkMode)
+           && getI32(blob, pos, s.uplinkPort)
+           && getStr(blob, pos, s.tcpServerIp)
+           && getI32(blob, pos, s.tcpPort)
+           && getStr(blob, pos, s.udpChasecarIp)
+           && getI32(blob, pos, s.udpChasecarPort)
+           && getI32(blob, pos, boolByte)
+           && getI32(blob, pos, s.udpKeyframeInterval)
+           && getI32(blob, pos, framingByte)
+           && getStr(blob, pos, s.udpMulticastGroup)
+           && getI32(blob, pos, s.udpMulticastTtl)
+           && getStr(blob, pos, s.udpMulticastInterface)
+           && getI32(blob, pos, compressByte)
+           && getI32(blob, pos, s.ethernetPort)
+           && getI32(blob, pos, s.fileSyncScanIntervalMs)
+           && getI32(blob, pos, s.metricsPort)
+           && getI32(blob, pos, s.fetchCpu)
+           && getI32(blob, pos, s.fetchRtPriority)
+           && getI32(blob, pos, s.backendCpu)
+           && getI32(blob, pos, s.backendRtPriority)
+           && getI32(blob, pos, raceByte);
+    if (!ok) {
+        return false;
+    }
+    s.udpDeltaMode = (boolByte != 0);
+    s.udpFramingV2 = (framingByte != 0);
+    s.frameCompression = (compressByte != 0);
+    s.raceMode = (raceByte != 0);
+    cached = s;
+    return true;
 }
 
-// Method to read the configuration file and return the parsed JSON object
-QJsonObject Config::readConfigFile(const QString &filePath) {
-    QFile file(filePath);  
+void Config::writeSettingsCache(const std::string& cachePath, const Settings& s) const {
+    struct stat src{};
+    if (stat(configPath.c_str(), &src) != 0) {
+        return;
+    }
+
+    std::vector<uint8_t> blob;
+    blob.insert(blob.end(), {'B', 'C', 'F', 'G'});
+    putI32(blob, (int32_t)CACHE_VERSION);
+    int64_t mtimeSec = src.st_mtim.tv_sec, mtimeNsec = src.st_mtim.tv_nsec;
+    int64_t size = src.st_size;
+    blob.insert(blob.end(), (uint8_t*)&mtimeSec, (uint8_t*)&mtimeSec + sizeof(mtimeSec));
+    blob.insert(blob.end(), (uint8_t*)&mtimeNsec, (uint8_t*)&mtimeNsec + sizeof(mtimeNsec));
+    blob.insert(blob.end(), (uint8_t*)&size, (uint8_t*)&size + sizeof(size));
+    putStr(blob, s.sqlServerUrl);
+    putI32(blob, s.sqlTransferTimeout);
+    putI32(blob, s.sqlRetryInterval);
+    putI32(blob, s.sqlBatchFrames);
+    putI32(blob, s.sqlBatchWindowMs);
+    putStr(blob, s.uplinkMode);
+    putI32(blob, s.uplinkPort);
+    putStr(blob, s.tcpServerIp);
+    putI32(blob, s.tcpPort);
+    putStr(blob, s.udpChasecarIp);
+    putI32(blob, s.udpChasecarPort);
+    putI32(blob, s.udpDeltaMode ? 1 : 0);
+    putI32(blob, s.udpKeyframeInterval);
+    putI32(blob, s.udpFramingV2 ? 1 : 0);
+    putStr(blob, s.udpMulticastGroup);
+    putI32(blob, s.udpMulticastTtl);
+    putStr(blob, s.udpMulticastInterface);
+    putI32(blob, s.frameCompression ? 1 : 0);
+    putI32(blob, s.ethernetPort);
+    putI32(blob, s.fileSyncScanIntervalMs);
+    putI32(blob, s.metricsPort);
+    putI32(blob, s.fetchCpu);
+    putI32(blob, s.fetchRtPriority);
+    putI32(blob, s.backendCpu);
+    putI32(blob, s.backendRtPriority);
+    putI32(blob, s.raceMode ? 1 : 0);
+
+    // write-then-rename so a crash mid-write can't leave a torn cache
+    std::string tmpPath = cachePath + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (fp == nullptr) {
+        return;
+    }
+    size_t written = fwrite(blob.data(), 1, blob.size(), fp);
+    fclose(fp);
+    if (written == blob.size()) {
+        rename(tmpPath.c_str(), cachePath.c_str());
+    } else {
+        remove(tmpPath.c_str());
+    }
+}
+
+// ---- hot reload -----------------------------------------------------------
+
+void Config::onChange(std::function<void(const Settings&)> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    changeCallbacks.push_back(std::move(callback));
+}
+
+void Config::startWatcher() {
+    if (configPath.empty() || watching.load()) {
+        return; // nothing to watch, or already running
+    }
+    watching = true;
+    watcher = std::thread(&Config::watchLoop, this);
+}
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Could not open config file:" << file.errorString();
-        return QJsonObject();  
+void Config::stopWatcher() {
+    watching = false;
+    if (watcher.joinable()) {
+        watcher.join();
     }
+}
+
+// Reload watcher. Polls the file's mtime rather than using inotify: editors
+// and scp replace the file with rename(), which silently orphans an inotify
+// watch on the old inode, and a 2 s poll of one stat is free at our scale.
+// A bad edit (invalid JSON) keeps the current settings and logs.
+void Config::watchLoop() {
+    struct stat last{};
+    stat(configPath.c_str(), &last);
+
+    while (watching.load()) {
+        // sleep in short slices so stopWatcher() doesn't block for the
+        // full poll interval
+        for (int slept = 0; slept < WATCH_INTERVAL_MS && watching.load(); slept += 100) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!watching.load()) {
+            break;
+        }
 
-    QByteArray fileData = file.readAll(); 
-    file.close();
+        struct stat now{};
+        if (stat(configPath.c_str(), &now) != 0) {
+            continue; // mid-rename; try again next tick
+        }
+        if (now.st_mtim.tv_sec == last.st_mtim.tv_sec &&
+            now.st_mtim.tv_nsec == last.st_mtim.tv_nsec &&
+            now.st_size == last.st_size) {
+            continue;
+        }
+        last = now;
 
-    QJsonDocument jsonDoc(QJsonDocument::fromJson(fileData));  
-    return jsonDoc.object();  
+        // parse into a local document: the shared configObject is not
+        // touched, so getInt/getString stay safe from other threads
+        FILE* fp = fopen(configPath.c_str(), "r");
+        if (fp == nullptr) {
+            continue;
+        }
+        char readBuffer[65536];
+        rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+        rapidjson::Document doc;
+        doc.ParseStream(is);
+        fclose(fp);
+        if (doc.HasParseError() || !doc.IsObject()) {
+            std::cerr << "Config: " << configPath
+                      << " changed but is not valid JSON, keeping current settings" << std::endl;
+            continue;
+        }
+
+        // missing keys fall back to the current values, not the compiled-in
+        // defaults, so deleting a line doesn't yank a setting mid-run
+        Settings next = *snapshot();
+        readSettings(doc, next);
+
+        auto fresh = std::make_shared<const Settings>(next);
+        std::atomic_store_explicit(&snap, std::shared_ptr<const Settings>(fresh),
+                                   std::memory_order_release);
+        gen.fetch_add(1, std::memory_order_release);
+        std::cout << "Config: reloaded " << configPath
+                  << " (generation " << gen.load() << ")" << std::endl;
+        writeSettingsCache(configPath + ".cache", next);
+
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        for (auto& callback : changeCallbacks) {
+            callback(*fresh);
+        }
+    }
 }
 
-QJsonObject Config::getConfig() const {
+// ---------------------------------------------------------------------------
+
+void Config::ensureParsed() const {
+    if (parsed) {
+        return;
+    }
+    readConfigFile(configPath);
+    if (!configObject.IsObject()) {
+        configObject.SetObject();
+    }
+    parsed = true;
+}
+
+// Method to read the configuration file and parse it into configObject
+void Config::readConfigFile(const std::string &filePath) const {
+    FILE* fp = fopen(filePath.c_str(), "r"); // NOTE: Windows: "rb"; non-Windows: "r"
+    if (fp == 0) {
+        return;
+    }
+
+    char readBuffer[65536];
+    rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+    configObject.ParseStream(is);
+    fclose(fp);
+
+    if (configObject.HasParseError()) {
+        std::cerr << "Config file " << filePath << " is not valid JSON" << std::endl;
+        configObject.SetNull();
+    }
+}
+
+const rapidjson::Document& Config::getConfig() const {
+    ensureParsed();
     return configObject;
 }
+
+int Config::getInt(const char* key, int defaultValue) const {
+    ensureParsed();
+    auto it = configObject.FindMember(key);
+    if (it != configObject.MemberEnd() && it->value.IsInt()) {
+        return it->value.GetInt();
+    }
+    return defaultValue;
+}
+
+std::string Config::getString(const char* key, const std::string& defaultValue) const {
+    ensureParsed();
+    auto it = configObject.FindMember(key);
+    if (it != configObject.MemberEnd() && it->value.IsString()) {
+        return it->value.GetString();
+    }
+    return defaultValue;
+}
+
+bool Config::getBool(const char* key, bool defaultValue) const {
+    ensureParsed();
+    auto it = configObject.FindMember(key);
+    if (it != configObject.MemberEnd() && it->value.IsBool()) {
+        return it->value.GetBool();
+    }
+    return defaultValue;
+}
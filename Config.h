@@ -1,23 +1,132 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-#include <QJsonObject>  
-#include <QString>      
-#include <QJsonDocument> 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "3rdparty/rapidjson/document.h"
 
 class Config {
 public:
-    
+
+    /**
+     * Every setting parsed once at load into plain fields, so hot paths read
+     * a struct member instead of doing a string-keyed JSON lookup per call.
+     */
+    struct Settings {
+        std::string sqlServerUrl;
+        int sqlTransferTimeout = 1000;
+        int sqlRetryInterval = 3000;
+        int sqlBatchFrames = 50;
+        int sqlBatchWindowMs = 1000;
+        std::string uplinkMode = "http"; // "http" (sql.h) or "binary" (binaryUplink.h)
+        int uplinkPort = 4010;
+        std::string tcpServerIp;
+        int tcpPort = 4005;
+        std::string udpChasecarIp;
+        int udpChasecarPort = 4003;
+        bool udpDeltaMode = false;       // off until the chase-car receiver speaks it
+        int udpKeyframeInterval = 50;    // full frame every N delta packets
+        bool udpFramingV2 = false;       // v2 framed datagrams; no in-band negotiation over UDP
+        // multicast publishing: a non-empty group (e.g. "239.255.41.1")
+        // switches the UDP sink from unicast to one send that reaches every
+        // listener on the convoy LAN; empty keeps unicast for cellular relays
+        std::string udpMulticastGroup;
+        int udpMulticastTtl = 1;           // convoy LAN only unless raised
+        std::string udpMulticastInterface; // egress interface address; empty = routing default
+        // deflate v2 payloads on the UDP sink and the file-sync log (~4x on
+        // our frames); TCP peers opt in per connection via the handshake
+        bool frameCompression = false;
+        int ethernetPort = 4005;
+        int fileSyncScanIntervalMs = 5000;
+        // Prometheus-style scrape endpoint (backend/metricsServer.h); 0 = off
+        int metricsPort = 9100;
+        // pipeline thread placement: cpu -1 = unpinned, priority 0 = default
+        // scheduler (> 0 = SCHED_FIFO at that priority)
+        int fetchCpu = -1;
+        int fetchRtPriority = 0;
+        int backendCpu = -1;
+        int backendRtPriority = 0;
+        // race mode: mlockall + slab prefault at startup so page faults
+        // never land in the frame path (backend/raceMode.h)
+        bool raceMode = false;
+    };
+
     static Config& getInstance();
-    QJsonObject getConfig() const;
+    const rapidjson::Document& getConfig() const;
+
+    // Boot-time snapshot: never changes after construction. Components that
+    // resolve their tunables once at startup read this, as before.
+    const Settings& settings() const { return cached; }
+
+    // Live snapshot: the watcher swaps in a new immutable Settings when
+    // config.json changes, so tunables can move without a restart (every
+    // restart is 30+ seconds of lost telemetry). The load is wait-free;
+    // holders keep a consistent view for as long as they keep the pointer.
+    std::shared_ptr<const Settings> snapshot() const {
+        return std::atomic_load_explicit(&snap, std::memory_order_acquire);
+    }
+
+    // Bumped on every successful reload; a component can poll this cheaply
+    // off its hot path and re-cache only when it moves
+    uint64_t generation() const { return gen.load(std::memory_order_acquire); }
+
+    // Called with the new snapshot after every reload, for components that
+    // cache derived state (the UDP sink's resolved chase-car address etc.)
+    void onChange(std::function<void(const Settings&)> callback);
+
+    // Start/stop the reload watcher thread; a no-op without a config file
+    void startWatcher();
+    void stopWatcher();
+
+    // Typed accessors with defaults so a missing key can't crash the pipeline.
+    // These parse the JSON lazily; prefer settings() on anything hot.
+    int getInt(const char* key, int defaultValue = 0) const;
+    std::string getString(const char* key, const std::string& defaultValue = "") const;
+    bool getBool(const char* key, bool defaultValue = false) const;
 
 private:
-    QJsonObject configObject;
+    // Bump whenever the Settings layout or the cache encoding changes
+    static constexpr uint32_t CACHE_VERSION = 8;
+
+    mutable rapidjson::Document configObject;
+    mutable bool parsed = false;
+    std::string configPath;
+    Settings cached;
+
+    // current immutable snapshot; replaced wholesale on reload
+    std::shared_ptr<const Settings> snap;
+    std::atomic<uint64_t> gen{1};
+    std::vector<std::function<void(const Settings&)>> changeCallbacks;
+    std::mutex callbackMutex;
+    std::thread watcher;
+    std::atomic<bool> watching{false};
+    static constexpr int WATCH_INTERVAL_MS = 2000;
 
     Config();
+    ~Config();
+
+    void ensureParsed() const;
+    void readConfigFile(const std::string& filePath) const;
+    void cacheSettings();
+
+    // Fill `s` from a parsed document; fields missing from the JSON keep
+    // whatever `s` already holds. Shared by boot parse and reload.
+    static void readSettings(const rapidjson::Document& doc, Settings& s);
+
+    // Reload watcher: polls the file's mtime, parses off-thread, validates,
+    // swaps the snapshot pointer and runs the change callbacks
+    void watchLoop();
+
+    // Binary snapshot of Settings keyed by the config file's mtime and size,
+    // so warm boots skip the JSON parse entirely
+    bool loadSettingsCache(const std::string& cachePath);
+    void writeSettingsCache(const std::string& cachePath, const Settings& s) const;
 
-    QJsonObject readConfigFile(const QString &filePath);
-    
     Config(const Config&) = delete;
     void operator=(const Config&) = delete;
 };
@@ -3,172 +3,416 @@
 //
 
 #include "dataUnpacker.h"
+#include "formatLayout.h"
+#include "Config.h"
+#include "backend/heartbeat.h"
+#include "backend/latencyStats.h"
+#include "backend/threadAffinity.h"
 
-double bytesToDouble(const std::vector<uint8_t>& data, int start_pos)
-{
-    double number;
-    const uint8_t* dataPtr = data.data();
-    memcpy(&number, &dataPtr[start_pos], sizeof(double));
-    return number;
-}
-
-float bytesToFloat(const std::vector<uint8_t>& data, int start_pos)
-{
-    float number;
-    const uint8_t* dataPtr = data.data();
-    memcpy(&number, &dataPtr[start_pos], sizeof(float));
-    return number;
-}
-
-template <typename E>
-E bytesToGeneralData(const std::vector<uint8_t>& data, int startPos, int endPos, E typeZero)
-{
-    int byteNum=endPos-startPos;
-    auto var = typeZero;
-
-    for(int i = endPos ; i>=startPos ; i--) {
-        var = var + (((uint8_t) data[i]) << (byteNum * 8));
-        byteNum--;
-    }
-
-    return var;
-}
-
-
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
 
 DataUnpacker::DataUnpacker()
 {
-    FILE* fp = fopen("./sc1-data-format/format.json", "r"); // NOTE: Windows: "rb"; non-Windows: "r"
-    if(fp == 0) {
-        fp = fopen("../sc1-data-format/format.json", "r"); // NOTE: Windows: "rb"; non-Windows: "r"
-    }
-
-    char readBuffer[65536];
-    FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-
-    Document d;
-    d.ParseStream(is);
-
-    int arrayOffset = 0;
+    // The packet layout is generated from sc1-data-format/format.json at build
+    // time (see tools/gen_format_layout.py), so there is no JSON to parse at
+    // startup anymore - just walk the constexpr field table once to find the
+    // offsets the pipeline needs.
     timestampOffsets tstampOff;
-    int dataCount = 0;
     cell_group_voltages_begin = -1;
     cell_group_voltages_end = -1;
 
-    for(Value::ConstMemberIterator itr = d.MemberBegin(); itr != d.MemberEnd(); ++itr) {
-        std::string name = itr->name.GetString();
-        const Value& arr = itr->value.GetArray();
+    for(int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+        const DataFormat::FieldInfo& field = DataFormat::FIELDS[i];
+        std::string name = field.name;
 
         names.push_back(name);
-        byteNums.push_back(arr[0].GetInt());
-        types.push_back(arr[1].GetString());
-
-        if(name == "tstamp_hr") {
-            tstampOff.hr = arrayOffset;
-        } else if(name == "tstamp_mn") {
-            tstampOff.mn = arrayOffset;
-        } else if(name == "tstamp_sc") {
-            tstampOff.sc = arrayOffset;
-        } else if(name == "tstamp_ms") {
-            tstampOff.ms = arrayOffset;
-        } else if(name == "tstamp_unix") {
-            tstampOff.unix = arrayOffset;
-        } else if(name.substr(0, 10) == "cell_group") {
+        byteNums.push_back(field.width);
+        switch(field.type) {
+            case DataFormat::FieldType::Bool:   types.push_back("bool");   break;
+            case DataFormat::FieldType::Uint8:  types.push_back("uint8");  break;
+            case DataFormat::FieldType::Uint16: types.push_back("uint16"); break;
+            case DataFormat::FieldType::Uint64: types.push_back("uint64"); break;
+            case DataFormat::FieldType::Float:  types.push_back("float");  break;
+            case DataFormat::FieldType::Double: types.push_back("double"); break;
+            case DataFormat::FieldType::Char:   types.push_back("char");   break;
+        }
+
+        if(name.substr(0, 10) == "cell_group") {
             if(cell_group_voltages_begin == -1) {
-                cell_group_voltages_begin = dataCount;
+                cell_group_voltages_begin = i;
             } else {
-                cell_group_voltages_end = dataCount;
+                cell_group_voltages_end = i;
             }
             cell_group_voltages.push_back(0);
-        } else if (name == "lat") {
-            gpsOffset.lat = arrayOffset;
-        } else if (name == "lon") {
-            gpsOffset.lon = arrayOffset;
-        } else if (name == "elev") {
-            gpsOffset.alt = arrayOffset;
         }
-        qDebug() << cell_group_voltages_begin;
-        arrayOffset += arr[0].GetInt();
-        dataCount++;
     }
 
-    fclose(fp);
-
+    // The format generator lays the cell group voltages out as contiguous
+    // floats; verify that here so unpack() can copy the whole block in one
+    // memcpy instead of dispatching per field.
+    cellBlockOffset = -1;
+    if(cell_group_voltages_begin != -1 && cell_group_voltages_end != -1) {
+        bool contiguous = true;
+        for(int i = cell_group_voltages_begin; i <= cell_group_voltages_end; i++) {
+            const DataFormat::FieldInfo& field = DataFormat::FIELDS[i];
+            if(field.type != DataFormat::FieldType::Float ||
+               field.offset != DataFormat::FIELDS[cell_group_voltages_begin].offset
+                               + (uint16_t)((i - cell_group_voltages_begin) * sizeof(float))) {
+                contiguous = false;
+                break;
+            }
+        }
+        if(contiguous) {
+            cellBlockOffset = DataFormat::FIELDS[cell_group_voltages_begin].offset;
+        }
+    }
 
-    BackendProcesses* retriever = new BackendProcesses(bytes, names, types, tstampOff, mutex, arrayOffset);
-    fetcher = new DataFetcher(bytes, arrayOffset, mutex, gpsOffset);
-    retriever->moveToThread(&backendThread);
-    fetcher->moveToThread(&dataFetchThread);
+    // These offsets are resolved against the generated table at compile time
+    tstampOff.hr = DataFormat::fieldOffset("tstamp_hr");
+    tstampOff.mn = DataFormat::fieldOffset("tstamp_mn");
+    tstampOff.sc = DataFormat::fieldOffset("tstamp_sc");
+    tstampOff.ms = DataFormat::fieldOffset("tstamp_ms");
+    tstampOff.unix = DataFormat::fieldOffset("tstamp_unix");
+    gpsOffset.lat = DataFormat::fieldOffset("lat");
+    gpsOffset.lon = DataFormat::fieldOffset("lon");
+    gpsOffset.alt = DataFormat::fieldOffset("elev");
+
+    bytes.resize(DataFormat::FRAME_SIZE);
+
+    bindFields();
+
+    ring = new FrameRing(DataFormat::FRAME_SIZE, 64);
+    retriever = new BackendProcesses(bytes, names, types, tstampOff, mutex, DataFormat::FRAME_SIZE, *ring);
+    fetcher = new DataFetcher(*ring, DataFormat::FRAME_SIZE, gpsOffset,
+                              DataFormat::fieldOffset("speed"));
+
+    // Wire the pipeline together: fetcher -> retriever -> decode stage
+    fetcher->setDataFetchedCallback([this]() { retriever->threadProcedure(); });
+    retriever->setDataReadyCallback([this](uint64_t ingressNs) { scheduleUnpack(ingressNs); });
+    retriever->setEngDashConnectionCallback([this](bool state) { eng_dash_connection(state); });
+}
 
-    connect(&dataFetchThread, &QThread::started, fetcher, &DataFetcher::startThread);
-    connect(this, &DataUnpacker::sendSignal, fetcher, &DataFetcher::sendData);
-    connect(&backendThread, &QThread::started, retriever, &BackendProcesses::startThread);
-    connect(retriever, &BackendProcesses::dataReady, this, &DataUnpacker::unpack);
-    connect(retriever, &BackendProcesses::eng_dash_connection, this, &DataUnpacker::eng_dash_connection);
-    connect(&backendThread, &QThread::finished, retriever, &QObject::deleteLater);
-    connect(&backendThread, &QThread::finished, &backendThread, &QThread::deleteLater);
-    connect(&dataFetchThread, &QThread::finished, fetcher, &DataFetcher::deleteLater);
-    connect(&dataFetchThread, &QThread::finished, &dataFetchThread, &QThread::deleteLater);
+DataUnpacker::~DataUnpacker()
+{
+    stop(); // Ensure threads are properly stopped
+    delete fetcher;
+    delete retriever;
+    delete ring;
+}
 
-    connect(fetcher, &DataFetcher::dataFetched, retriever, &BackendProcesses::threadProcedure);
+// Resolve each format field to the member it decodes into, once. The per
+// frame loop in unpack() then runs off this POD slot array with no string
+// comparisons or hashing.
+void DataUnpacker::bindFields()
+{
+    struct Slot {
+        SlotType type;
+        void* dst;
+    };
+    const std::unordered_map<std::string, Slot> slotTable = {
+        {"fan_speed", {SlotType::Uint8, &fan_speed}},
+        {"tstamp_hr", {SlotType::Uint8, &tstamp_hr}},
+        {"tstamp_mn", {SlotType::Uint8, &tstamp_mn}},
+        {"tstamp_sc", {SlotType::Uint8, &tstamp_sc}},
+        {"tstamp_ms", {SlotType::Uint16, &tstamp_ms}},
+        {"speed", {SlotType::Float, &speed}},
+        {"accelerator_pedal", {SlotType::Float, &accelerator_pedal}},
+        {"crz_spd_setpt", {SlotType::Float, &crz_spd_setpt}},
+        {"crz_pwr_setpt", {SlotType::Float, &crz_pwr_setpt}},
+        {"soc", {SlotType::Float, &soc}},
+        {"est_supplemental_soc", {SlotType::Float, &est_supplemental_soc}},
+        {"mppt_current_out", {SlotType::Float, &mppt_current_out}},
+        {"pack_voltage", {SlotType::Float, &pack_voltage}},
+        {"pack_current", {SlotType::Float, &pack_current}},
+        {"supplemental_voltage", {SlotType::Float, &supplemental_voltage}},
+        {"bms_input_voltage", {SlotType::Float, &bms_input_voltage}},
+        {"motor_power", {SlotType::Float, &motor_power}},
+        {"pack_temp", {SlotType::Float, &pack_temp}},
+        {"motor_temp", {SlotType::Float, &motor_temp}},
+        {"driverIO_temp", {SlotType::Float, &driverIO_temp}},
+        {"mainIO_temp", {SlotType::Float, &mainIO_temp}},
+        {"cabin_temp", {SlotType::Float, &cabin_temp}},
+        {"motor_controller_temp", {SlotType::Float, &motor_controller_temp}},
+        {"string1_temp", {SlotType::Float, &string1_temp}},
+        {"string2_temp", {SlotType::Float, &string2_temp}},
+        {"string3_temp", {SlotType::Float, &string3_temp}},
+        {"lat", {SlotType::Float, &lat}},
+        {"lon", {SlotType::Float, &lon}},
+        {"elev", {SlotType::Float, &elev}},
+        {"headlights", {SlotType::Bool, &headlights}},
+        {"l_turn_led_en", {SlotType::Bool, &l_turn_led_en}},
+        {"r_turn_led_en", {SlotType::Bool, &r_turn_led_en}},
+        {"hazards", {SlotType::Bool, &hazards}},
+        {"mainIO_heartbeat", {SlotType::Bool, &mainIO_heartbeat}},
+        {"crz_pwr_mode", {SlotType::Bool, &crz_pwr_mode}},
+        {"crz_spd_mode", {SlotType::Bool, &crz_spd_mode}},
+        {"eco", {SlotType::Bool, &eco}},
+        {"main_telem", {SlotType::Bool, &main_telem}},
+        {"parking_brake", {SlotType::Bool, &parking_brake}},
+        {"driver_eStop", {SlotType::Bool, &driver_eStop}},
+        {"external_eStop", {SlotType::Bool, &external_eStop}},
+        {"crash", {SlotType::Bool, &crash}},
+        {"door", {SlotType::Bool, &door}},
+        {"mcu_check", {SlotType::Bool, &mcu_check}},
+        {"isolation", {SlotType::Bool, &isolation}},
+        {"bps_fault", {SlotType::Bool, &bps_fault}},
+        {"discharge_enable", {SlotType::Bool, &discharge_enable}},
+        {"charge_enable", {SlotType::Bool, &charge_enable}},
+        {"bms_can_heartbeat", {SlotType::Bool, &bms_can_heartbeat}},
+        {"mcu_hv_en", {SlotType::Bool, &mcu_hv_en}},
+        {"mcu_stat_fdbk", {SlotType::Bool, &mcu_stat_fdbk}},
+        {"use_dcdc", {SlotType::Bool, &use_dcdc}},
+        {"supplemental_valid", {SlotType::Bool, &supplemental_valid}},
+        {"mppt_contactor", {SlotType::Bool, &mppt_contactor}},
+        {"low_contactor", {SlotType::Bool, &low_contactor}},
+        {"motor_controller_contactor", {SlotType::Bool, &motor_controller_contactor}},
+        {"voltage_failsafe", {SlotType::Bool, &voltage_failsafe}},
+        {"current_failsafe", {SlotType::Bool, &current_failsafe}},
+        {"input_power_supply_failsafe", {SlotType::Bool, &input_power_supply_failsafe}},
+        {"relay_failsafe", {SlotType::Bool, &relay_failsafe}},
+        {"cell_balancing_active", {SlotType::Bool, &cell_balancing_active}},
+        {"charge_interlock_failsafe", {SlotType::Bool, &charge_interlock_failsafe}},
+        {"thermistor_b_value_table_invalid", {SlotType::Bool, &thermistor_b_value_table_invalid}},
+        {"state", {SlotType::String, &state}},
+    };
+
+    boundFields.clear();
+    boundFields.reserve(DataFormat::FIELD_COUNT);
+    for(int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+        const DataFormat::FieldInfo& field = DataFormat::FIELDS[i];
+        auto it = slotTable.find(field.name);
+        if(it != slotTable.end()) {
+            boundFields.push_back({it->second.type, it->second.dst, field.offset, field.width, (uint16_t)i});
+        } else if((i >= cell_group_voltages_begin) && (i <= cell_group_voltages_end)) {
+            // the batch path in unpack() handles a contiguous block; only
+            // bind per-field slots if the layout ever turns out scattered
+            if(cellBlockOffset == -1) {
+                boundFields.push_back({SlotType::Float, &cell_group_voltages[i - cell_group_voltages_begin], field.offset, field.width, (uint16_t)i});
+            }
+        }
+        // TODO: No double data yet; Implement when there is double data
+    }
 
-    backendThread.start();
-    dataFetchThread.start();
+    lazySlots.clear();
+    for(size_t i = 0; i < boundFields.size(); i++) {
+        lazySlots.emplace(boundFields[i].dst, i);
+    }
 }
 
-DataUnpacker::~DataUnpacker()
+// Decode one slot from a stable frame image; shared by the eager unpack()
+// loop and the lazy getter path
+void DataUnpacker::decodeField(BoundField& field, const std::vector<uint8_t>& src)
 {
-    stop(); // Ensure threads are properly stopped
+    switch(field.type) {
+        case SlotType::Float:
+            *static_cast<float*>(field.dst) = readField<float>(src, field.offset);
+            break;
+        case SlotType::Uint8:
+            *static_cast<uint8_t*>(field.dst) = readField<uint8_t>(src, field.offset);
+            break;
+        case SlotType::Uint16:
+            *static_cast<uint16_t*>(field.dst) = readField<uint16_t>(src, field.offset);
+            break;
+        case SlotType::Bool:
+            *static_cast<bool*>(field.dst) = readField<uint8_t>(src, field.offset) != 0;
+            break;
+        case SlotType::String:
+            *static_cast<std::string*>(field.dst) = std::string(1, (char)readField<uint8_t>(src, field.offset));
+            break;
+    }
+    field.decoded = true;
 }
 
-void DataUnpacker::unpack()
+// Lazy path behind the getters: a no-op for anything that is not a frame
+// field or was already decoded, otherwise decode from the last unpacked
+// frame under the mutex.
+void DataUnpacker::touchField(const void* dst) const
 {
-    int currByte = 0;
+    auto it = lazySlots.find(dst);
+    if(it == lazySlots.end()) {
+        return; // computed member, not backed by a frame field
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    BoundField& field = boundFields[it->second];
+    if(!field.decoded && !prevBytes.empty()) {
+        const_cast<DataUnpacker*>(this)->decodeField(field, prevBytes);
+    }
+}
 
-    mutex.lock();
+void DataUnpacker::subscribe(const std::vector<std::string>& fieldNames, DataChangeCallback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!haveSubscriptions) {
+        // first subscriber: flip unpack() from decode-everything to
+        // decode-the-subscribed-union
+        haveSubscriptions = true;
+        for(BoundField& field : boundFields) {
+            field.eager = false;
+        }
+    }
 
-    for(uint i=0; i < names.size(); i++) {
-        if(types[i] == "float") {
-            // Make sure the property exists
-            if(this->property(names[i].c_str()).isValid()) {
-                this->setProperty(names[i].c_str(), bytesToFloat(bytes, currByte));
-            } else if((i >= cell_group_voltages_begin) && (i <= cell_group_voltages_end)) {
-                cell_group_voltages[i - cell_group_voltages_begin] = bytesToFloat(bytes, currByte);
-            }
-        } else if(types[i] == "uint8") {
-            // Make sure the property exists
-            if(this->property(names[i].c_str()).isValid()) {
-                this->setProperty(names[i].c_str(), bytesToGeneralData(bytes, currByte, currByte + byteNums[i] - 1, (uint8_t)0));
+    Subscriber sub;
+    sub.wants.assign(DataFormat::FIELD_COUNT, false);
+    sub.callback = std::move(callback);
+    for(const std::string& name : fieldNames) {
+        bool found = false;
+        for(BoundField& field : boundFields) {
+            if(name == DataFormat::FIELDS[field.fieldIndex].name) {
+                field.eager = true;
+                sub.wants[field.fieldIndex] = true;
+                found = true;
+                break;
             }
-        } else if(types[i] == "uint16") {
-            // Make sure the property exists
-            if(this->property(names[i].c_str()).isValid()) {
-                this->setProperty(names[i].c_str(), bytesToGeneralData(bytes, currByte, currByte + byteNums[i] - 1, (uint16_t)0));
+        }
+        // cell group voltages ride the batch block path, which always
+        // decodes; a subscription just routes their change notifications
+        if(!found && cell_group_voltages_begin != -1) {
+            for(int i = cell_group_voltages_begin; i <= cell_group_voltages_end; i++) {
+                if(name == DataFormat::FIELDS[i].name) {
+                    sub.wants[i] = true;
+                    found = true;
+                    break;
+                }
             }
-        } else if(types[i] == "bool") {
-            // Make sure the property exists
-            if(this->property(names[i].c_str()).isValid()) {
-                this->setProperty(names[i].c_str(), bytesToGeneralData(bytes, currByte, currByte + byteNums[i] - 1, false));
+        }
+        if(!found) {
+            std::cout << "DataUnpacker: cannot subscribe to unknown field " << name << std::endl;
+        }
+    }
+    subscribers.push_back(std::move(sub));
+}
+
+void DataUnpacker::unpack()
+{
+    mutex.lock();
+
+    // Dirty detection: compare each field's raw bytes against the previous
+    // frame and only decode what actually moved. The first frame has no
+    // predecessor, so everything is dirty.
+    const bool firstFrame = prevBytes.empty();
+    changedFields.clear();
+
+    for(BoundField& field : boundFields) {
+        if(!firstFrame &&
+           memcmp(bytes.data() + field.offset, prevBytes.data() + field.offset, field.width) == 0) {
+            continue;
+        }
+        changedFields.push_back(field.fieldIndex);
+        if(field.eager) {
+            decodeField(field, bytes);
+        } else {
+            // nobody subscribed to this one; a getter decodes it on demand
+            field.decoded = false;
+        }
+    }
+
+    // Cell voltages are contiguous floats in the frame: one memcpy lands the
+    // whole block, and min/max/mean fall out of the same pass so the BMS
+    // display gets the min-cell figure without a second walk.
+    if(cellBlockOffset != -1 && !cell_group_voltages.empty()) {
+        size_t blockBytes = cell_group_voltages.size() * sizeof(float);
+        if(firstFrame ||
+           memcmp(bytes.data() + cellBlockOffset, prevBytes.data() + cellBlockOffset, blockBytes) != 0) {
+            // word-compare each cell against the old block before it is
+            // overwritten, so dirty reporting stays per field
+            for(size_t i = 0; i < cell_group_voltages.size(); i++) {
+                if(firstFrame ||
+                   memcmp(bytes.data() + cellBlockOffset + i * sizeof(float),
+                          prevBytes.data() + cellBlockOffset + i * sizeof(float),
+                          sizeof(float)) != 0) {
+                    changedFields.push_back((uint16_t)(cell_group_voltages_begin + i));
+                }
             }
-        } else if(types[i] == "char") {
-            // Make sure the property exists
-            if(this->property(names[i].c_str()).isValid()) {
-                // NOTE: char data is displayed as its ASCII decimal value, not the character, so QString is used instead
-                this->setProperty(names[i].c_str(), QString::fromStdString(std::string(1, bytesToGeneralData(bytes, currByte, currByte + byteNums[i] - 1, (char)0))));
+            memcpy(cell_group_voltages.data(), bytes.data() + cellBlockOffset, blockBytes);
+            float vMin = cell_group_voltages[0];
+            float vMax = cell_group_voltages[0];
+            float sum = 0;
+            for(float v : cell_group_voltages) {
+                vMin = v < vMin ? v : vMin;
+                vMax = v > vMax ? v : vMax;
+                sum += v;
             }
-        } else if(types[i] == "double") {
-            // TODO: No double data yet; Implement when there is double data
+            cell_voltage_min = vMin;
+            cell_voltage_max = vMax;
+            cell_voltage_mean = sum / (float)cell_group_voltages.size();
         }
-
-        currByte += byteNums[i];
     }
 
+    // publish the decoded frame to the shared-memory snapshot while the
+    // frame bytes are still stable under the mutex
+    shm.publish(bytes);
+
+    prevBytes = bytes; // capacity matches after the first frame: plain copy
+
     mutex.unlock();
 
     this->restart_enable = checkRestartEnable();
 
-    // Refresh frontend
-    QGuiApplication::processEvents();
+    // Refresh frontend; a frame where nothing moved needs no redraw
+    if(!changedFields.empty()) {
+        notifyDataChanged();
+        // subscribers get only the intersection with their field set
+        for(Subscriber& sub : subscribers) {
+            sub.scratch.clear();
+            for(uint16_t idx : changedFields) {
+                if(sub.wants[idx]) {
+                    sub.scratch.push_back(idx);
+                }
+            }
+            if(!sub.scratch.empty()) {
+                sub.callback(sub.scratch);
+            }
+        }
+    }
+}
+
+// Called on the backend thread after it publishes a snapshot into `bytes`;
+// just flags the decode thread and returns, so the backend never waits on a
+// decode. Coalescing is free: a second frame before the decode wakes simply
+// overwrites the pending ingress stamp, and unpack() reads the newest bytes.
+void DataUnpacker::scheduleUnpack(uint64_t ingressNs)
+{
+    bool wasPending;
+    {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        wasPending = decodePending;
+        decodePending = true;
+        pendingIngressNs = ingressNs;
+    }
+    if (!wasPending) {
+        decodeCv.notify_one();
+    }
+}
+
+void DataUnpacker::decodeLoop()
+{
+    static Heartbeat& heartbeat = PipelineWatchdog::getInstance().stage("decode");
+    std::unique_lock<std::mutex> lock(decodeMutex);
+    while (running) {
+        decodeCv.wait_for(lock, std::chrono::milliseconds(100),
+                          [this] { return decodePending || !running; });
+        if (!running) {
+            return;
+        }
+        if (!decodePending) {
+            continue;
+        }
+        decodePending = false;
+        uint64_t ingressNs = pendingIngressNs;
+        lock.unlock();
+
+        unpack();
+        heartbeat.beat();
+        if (ingressNs != 0) {
+            static LatencyHistogram& toUnpack = LatencyStats::getInstance().stage("ingress_to_unpack");
+            toUnpack.record(LatencyStats::nowNs() - ingressNs);
+        }
+
+        lock.lock();
+    }
 }
 
 void DataUnpacker::eng_dash_connection(bool state) {
@@ -176,27 +420,62 @@ void DataUnpacker::eng_dash_connection(bool state) {
 }
 
 bool DataUnpacker::checkRestartEnable() {
-    return (!restart_enable ? !mcu_hv_en : false) || driver_eStop || external_eStop || isolation || door || crash || mcu_check || discharge_enable || restart_enable;
+    // via the getters, not the raw members: the shutdown-circuit fields must
+    // reflect this frame even when no subscription keeps them eager
+    return (!restart_enable ? !getMcuHvEn() : false) || getDriverEStop() || getExternalEStop() || getIsolation() || getDoor() || getCrash() || getMcuCheck() || getDischargeEnable() || restart_enable;
 }
 
 void DataUnpacker::enableRestart() {
-    // Send restart signal to backend
-    // TODO: Implement backend communication without Qt signals
+    // restart-enable goes back up the ingest socket as a sequence-numbered
+    // command, retransmitted until a board acks it. It never queues behind
+    // telemetry: commands are the only traffic in that direction and the
+    // sockets run with TCP_NODELAY, so after a BPS fault the board sees the
+    // driver's restart within an epoll wakeup.
+    fetcher->sendCommand(CommandChannel::RESTART_ENABLE);
 }
 
 void DataUnpacker::start() {
     running = true;
-    // TODO: Start data processing threads
+
+    // pinning/priority come from config.json; each thread applies its own
+    // policy first thing so the whole stage runs under it
+    const Config::Settings& settings = Config::getInstance().settings();
+    backendThread = std::thread([this, cpu = settings.backendCpu, prio = settings.backendRtPriority]() {
+        applyThreadPolicy("backend", cpu, prio);
+        retriever->startThread();
+    });
+    auto fetchBody = [this, cpu = settings.fetchCpu, prio = settings.fetchRtPriority]() {
+        applyThreadPolicy("fetch", cpu, prio);
+        fetcher->startThread();
+    };
+    dataFetchThread = std::thread(fetchBody);
+    decodeThread = std::thread(&DataUnpacker::decodeLoop, this);
+
+    // the watchdog can bounce a wedged (or dead - e.g. bind failure) fetch
+    // thread; sources reconnect on their own, so the kick is cheap
+    PipelineWatchdog::getInstance().setRestart("fetch", [this, fetchBody]() {
+        fetcher->stop();
+        if (dataFetchThread.joinable()) {
+            dataFetchThread.join();
+        }
+        dataFetchThread = std::thread(fetchBody);
+    });
 }
 
 void DataUnpacker::stop() {
     running = false;
+    retriever->stop();
+    fetcher->stop();
+    decodeCv.notify_all();
     if (dataFetchThread.joinable()) {
         dataFetchThread.join();
     }
     if (backendThread.joinable()) {
         backendThread.join();
     }
+    if (decodeThread.joinable()) {
+        decodeThread.join();
+    }
 }
 
 void DataUnpacker::setDataChangeCallback(DataChangeCallback callback) {
@@ -205,7 +484,6 @@ void DataUnpacker::setDataChangeCallback(DataChangeCallback callback) {
 
 void DataUnpacker::notifyDataChanged() {
     if (dataChangeCallback) {
-        dataChangeCallback();
+        dataChangeCallback(changedFields);
     }
 }
-
@@ -6,27 +6,52 @@
 #ifndef DATAPROCESSOR_DATAUNPACKER_H
 #define DATAPROCESSOR_DATAUNPACKER_H
 
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 #include <functional>
 #include <vector>
 #include <string>
 #include <atomic>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
 #include "backend/backendProcesses.h"
 #include "backend/dataFetcher.h"
-#include "3rdparty/rapidjson/document.h"
-#include "3rdparty/rapidjson/filereadstream.h"
-
-using namespace rapidjson;
+#include "DataProcessor/shmSnapshot.h"
 
 // Forward declaration for GPS data structure
 struct GPSData;
 
+// Typed field accessors used by unpack(); in the header so the benchmark
+// target can measure them in isolation. Frame fields are little-endian on
+// the wire, so on the little-endian targets we run this compiles to a plain
+// (possibly unaligned) load; a big-endian host would get the byte swap. The
+// width is sizeof(T) at compile time - no runtime start/end arithmetic, no
+// per-byte shift-add loop.
+template <typename T>
+inline T readField(const std::vector<uint8_t>& data, size_t offset)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    memcpy(&value, data.data() + offset, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+        auto* bytes = reinterpret_cast<uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T) / 2; i++) {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+    }
+    return value;
+}
+
 class DataUnpacker
 {
 public:
-    // Callback function type for data change notifications
-    using DataChangeCallback = std::function<void()>;
+    // Callback function type for data change notifications; carries the
+    // format-field indices (into DataFormat::FIELDS) that changed this frame
+    // so consumers can redraw incrementally instead of repainting everything
+    using DataChangeCallback = std::function<void(const std::vector<uint16_t>&)>;
     
     explicit DataUnpacker();
     ~DataUnpacker();
@@ -37,97 +62,131 @@ public:
     
     // Set callback for data change notifications
     void setDataChangeCallback(DataChangeCallback callback);
+
+    // Register interest in a set of fields by name, resolved against the
+    // format table once here so the per-frame path stays pure index work.
+    // Once any subscriber exists, unpack() decodes only the union of
+    // subscribed fields eagerly; every other field is decoded lazily the
+    // first time its getter is called after a change. The callback fires
+    // with the subset of this subscription's fields that changed.
+    // Call before start(); registration takes the frame mutex.
+    void subscribe(const std::vector<std::string>& fieldNames, DataChangeCallback callback);
     
+    // Raw frame bytes unpack() reads from; exposed for the benchmark target
+    std::vector<uint8_t>& rawBytes() { return bytes; }
+
     // Public interface methods (replacements for Qt slots)
     void unpack();
     void eng_dash_connection(bool state);
     void enableRestart();
     
-    // Getter methods for telemetry data (replacements for Q_PROPERTY)
-    int getFanSpeed() const { return fan_speed; }
-    int getTstampHr() const { return tstamp_hr; }
-    int getTstampMn() const { return tstamp_mn; }
-    int getTstampSc() const { return tstamp_sc; }
-    int getTstampMs() const { return tstamp_ms; }
-    
-    bool getLTurnLedEn() const { return l_turn_led_en; }
-    bool getRTurnLedEn() const { return r_turn_led_en; }
-    bool getHazards() const { return hazards; }
-    bool getHeadlights() const { return headlights; }
-    bool getMainIOHeartbeat() const { return mainIO_heartbeat; }
+    // Getter methods for telemetry data (replacements for Q_PROPERTY).
+    // Each frame-field getter runs the member through touchField() first:
+    // a field left undecoded by a subscription-narrowed unpack() is decoded
+    // here on first access, so unsubscribed consumers still read fresh data.
+    int getFanSpeed() const { touchField(&fan_speed); return fan_speed; }
+    int getTstampHr() const { touchField(&tstamp_hr); return tstamp_hr; }
+    int getTstampMn() const { touchField(&tstamp_mn); return tstamp_mn; }
+    int getTstampSc() const { touchField(&tstamp_sc); return tstamp_sc; }
+    int getTstampMs() const { touchField(&tstamp_ms); return tstamp_ms; }
+
+    bool getLTurnLedEn() const { touchField(&l_turn_led_en); return l_turn_led_en; }
+    bool getRTurnLedEn() const { touchField(&r_turn_led_en); return r_turn_led_en; }
+    bool getHazards() const { touchField(&hazards); return hazards; }
+    bool getHeadlights() const { touchField(&headlights); return headlights; }
+    bool getMainIOHeartbeat() const { touchField(&mainIO_heartbeat); return mainIO_heartbeat; }
     bool getEngDashCommfail() const { return eng_dash_commfail; }
-    bool getCrzPwrMode() const { return crz_pwr_mode; }
-    bool getCrzSpdMode() const { return crz_spd_mode; }
+    bool getCrzPwrMode() const { touchField(&crz_pwr_mode); return crz_pwr_mode; }
+    bool getCrzSpdMode() const { touchField(&crz_spd_mode); return crz_spd_mode; }
+
 
-    
     // Additional getter methods for shutdown circuit data
-    bool getDriverEStop() const { return driver_eStop; }
-    bool getExternalEStop() const { return external_eStop; }
-    bool getCrash() const { return crash; }
-    bool getDoor() const { return door; }
-    bool getMcuCheck() const { return mcu_check; }
-    bool getIsolation() const { return isolation; }
-    bool getDischargeEnable() const { return discharge_enable; }
-    bool getLowContactor() const { return low_contactor; }
-    bool getBmsCanHeartbeat() const { return bms_can_heartbeat; }
-    bool getVoltageFailsafe() const { return voltage_failsafe; }
-    bool getCurrentFailsafe() const { return current_failsafe; }
-    bool getInputPowerSupplyFailsafe() const { return input_power_supply_failsafe; }
-    bool getRelayFailsafe() const { return relay_failsafe; }
-    bool getCellBalancingActive() const { return cell_balancing_active; }
-    bool getChargeInterlockFailsafe() const { return charge_interlock_failsafe; }
-    bool getThermistorBValueTableInvalid() const { return thermistor_b_value_table_invalid; }
-    bool getChargeEnable() const { return charge_enable; }
-    bool getBpsFault() const { return bps_fault; }
-    bool getUseDcdc() const { return use_dcdc; }
-    bool getSupplementalValid() const { return supplemental_valid; }
-    bool getMcuHvEn() const { return mcu_hv_en; }
-    bool getMcuStatFdbk() const { return mcu_stat_fdbk; }
-    bool getParkingBrake() const { return parking_brake; }
-    bool getEco() const { return eco; }
-    bool getMainTelem() const { return main_telem; }
+    bool getDriverEStop() const { touchField(&driver_eStop); return driver_eStop; }
+    bool getExternalEStop() const { touchField(&external_eStop); return external_eStop; }
+    bool getCrash() const { touchField(&crash); return crash; }
+    bool getDoor() const { touchField(&door); return door; }
+    bool getMcuCheck() const { touchField(&mcu_check); return mcu_check; }
+    bool getIsolation() const { touchField(&isolation); return isolation; }
+    bool getDischargeEnable() const { touchField(&discharge_enable); return discharge_enable; }
+    bool getLowContactor() const { touchField(&low_contactor); return low_contactor; }
+    bool getBmsCanHeartbeat() const { touchField(&bms_can_heartbeat); return bms_can_heartbeat; }
+    bool getVoltageFailsafe() const { touchField(&voltage_failsafe); return voltage_failsafe; }
+    bool getCurrentFailsafe() const { touchField(&current_failsafe); return current_failsafe; }
+    bool getInputPowerSupplyFailsafe() const { touchField(&input_power_supply_failsafe); return input_power_supply_failsafe; }
+    bool getRelayFailsafe() const { touchField(&relay_failsafe); return relay_failsafe; }
+    bool getCellBalancingActive() const { touchField(&cell_balancing_active); return cell_balancing_active; }
+    bool getChargeInterlockFailsafe() const { touchField(&charge_interlock_failsafe); return charge_interlock_failsafe; }
+    bool getThermistorBValueTableInvalid() const { touchField(&thermistor_b_value_table_invalid); return thermistor_b_value_table_invalid; }
+    bool getChargeEnable() const { touchField(&charge_enable); return charge_enable; }
+    bool getBpsFault() const { touchField(&bps_fault); return bps_fault; }
+    bool getUseDcdc() const { touchField(&use_dcdc); return use_dcdc; }
+    bool getSupplementalValid() const { touchField(&supplemental_valid); return supplemental_valid; }
+    bool getMcuHvEn() const { touchField(&mcu_hv_en); return mcu_hv_en; }
+    bool getMcuStatFdbk() const { touchField(&mcu_stat_fdbk); return mcu_stat_fdbk; }
+    bool getParkingBrake() const { touchField(&parking_brake); return parking_brake; }
+    bool getEco() const { touchField(&eco); return eco; }
+    bool getMainTelem() const { touchField(&main_telem); return main_telem; }
     int getMcStatus() const { return mc_status; }
     bool getRestartEnable() const { return restart_enable; }
 
-    
-    // Float getters  
-    float getSpeed() const { return speed; }
-    float getAcceleratorPedal() const { return accelerator_pedal; }
-    float getSoc() const { return soc; }
-    float getMpptCurrentOut() const { return mppt_current_out; }
-    float getPackVoltage() const { return pack_voltage; }
-    float getPackCurrent() const { return pack_current; }
-    float getPackTemp() const { return pack_temp; }
-    float getBmsInputVoltage() const { return bms_input_voltage; }
-    float getMotorTemp() const { return motor_temp; }
-    float getMotorPower() const { return motor_power; }
-    float getDriverIOTemp() const { return driverIO_temp; }
-    float getMainIOTemp() const { return mainIO_temp; }
-    float getMotorControllerTemp() const { return motor_controller_temp; }
-    float getCabinTemp() const { return cabin_temp; }
-    float getString1Temp() const { return string1_temp; }
-    float getString2Temp() const { return string2_temp; }
-    float getString3Temp() const { return string3_temp; }
-    float getCrzPwrSetpt() const { return crz_pwr_setpt; }
-    float getCrzSpdSetpt() const { return crz_spd_setpt; }
-    float getSupplementalVoltage() const { return supplemental_voltage; }
-    float getEstSupplementalSoc() const { return est_supplemental_soc; }
-    std::string getState() const { return state; }
-    float getLat() const { return lat; }
-    float getLon() const { return lon; }
-    float getElev() const { return elev; }
+
+    // Float getters
+    float getSpeed() const { touchField(&speed); return speed; }
+    float getAcceleratorPedal() const { touchField(&accelerator_pedal); return accelerator_pedal; }
+    float getSoc() const { touchField(&soc); return soc; }
+    float getMpptCurrentOut() const { touchField(&mppt_current_out); return mppt_current_out; }
+    float getPackVoltage() const { touchField(&pack_voltage); return pack_voltage; }
+    float getPackCurrent() const { touchField(&pack_current); return pack_current; }
+    float getPackTemp() const { touchField(&pack_temp); return pack_temp; }
+    float getBmsInputVoltage() const { touchField(&bms_input_voltage); return bms_input_voltage; }
+    float getMotorTemp() const { touchField(&motor_temp); return motor_temp; }
+    float getMotorPower() const { touchField(&motor_power); return motor_power; }
+    float getDriverIOTemp() const { touchField(&driverIO_temp); return driverIO_temp; }
+    float getMainIOTemp() const { touchField(&mainIO_temp); return mainIO_temp; }
+    float getMotorControllerTemp() const { touchField(&motor_controller_temp); return motor_controller_temp; }
+    float getCabinTemp() const { touchField(&cabin_temp); return cabin_temp; }
+    float getString1Temp() const { touchField(&string1_temp); return string1_temp; }
+    float getString2Temp() const { touchField(&string2_temp); return string2_temp; }
+    float getString3Temp() const { touchField(&string3_temp); return string3_temp; }
+    float getCrzPwrSetpt() const { touchField(&crz_pwr_setpt); return crz_pwr_setpt; }
+    float getCrzSpdSetpt() const { touchField(&crz_spd_setpt); return crz_spd_setpt; }
+    float getSupplementalVoltage() const { touchField(&supplemental_voltage); return supplemental_voltage; }
+    float getEstSupplementalSoc() const { touchField(&est_supplemental_soc); return est_supplemental_soc; }
+    std::string getState() const { touchField(&state); return state; }
+    float getLat() const { touchField(&lat); return lat; }
+    float getLon() const { touchField(&lon); return lon; }
+    float getElev() const { touchField(&elev); return elev; }
     
     const std::vector<float>& getCellGroupVoltages() const { return cell_group_voltages; }
+    // Computed in the same pass as the batch cell-voltage decode
+    float getMinCellVoltage() const { return cell_voltage_min; }
+    float getMaxCellVoltage() const { return cell_voltage_max; }
+    float getMeanCellVoltage() const { return cell_voltage_mean; }
 private:
     bool checkRestartEnable();
-    
+
     // Callback for data changes
     DataChangeCallback dataChangeCallback;
-    
+
+    // Shared-memory snapshot for local consumers (Textual dashboard etc.)
+    ShmSnapshot shm;
+
     // Threading control
     std::thread dataFetchThread, backendThread;
     std::atomic<bool> running{false};
 
+    // Decode stage: the backend publishes a frame snapshot and pokes this
+    // thread, then moves straight on to the next frame - decode of frame N
+    // overlaps send and ingestion of frame N+1. Latest-wins: if decode falls
+    // behind, it unpacks whatever snapshot is current when it wakes.
+    void scheduleUnpack(uint64_t ingressNs);
+    void decodeLoop();
+    std::thread decodeThread;
+    std::mutex decodeMutex;
+    std::condition_variable decodeCv;
+    bool decodePending = false;
+    uint64_t pendingIngressNs = 0;
+
     // TODO Include only the properties that need to be displayed on the driver dashboard
     uint8_t fan_speed, tstamp_hr, tstamp_mn, tstamp_sc;
     uint16_t tstamp_ms;
@@ -158,14 +217,51 @@ private:
     int mc_status=0;
 
     int cell_group_voltages_begin, cell_group_voltages_end; // First and last indices of the cell group voltages in data format
+    int cellBlockOffset; // frame offset of the contiguous float block, -1 if scattered
+    float cell_voltage_min=0, cell_voltage_max=0, cell_voltage_mean=0;
+
+    // One slot per format field we care about, resolved once at construction
+    // so unpack() is pure offset arithmetic (no name lookups on the hot path).
+    enum class SlotType : uint8_t { Bool, Uint8, Uint16, Float, String };
+    struct BoundField {
+        SlotType type;
+        void* dst;           // member this field decodes into
+        uint16_t offset;     // byte offset within the frame
+        uint8_t width;       // field width in bytes
+        uint16_t fieldIndex; // index into DataFormat::FIELDS, for dirty reporting
+        bool eager = true;   // decoded in unpack(); false once subscriptions narrow the set
+        bool decoded = true; // false while a lazy field is dirty but not yet read
+    };
+    // mutable: touchField() decodes into the slot from const getters
+    mutable std::vector<BoundField> boundFields;
+    void bindFields();
+    void decodeField(BoundField& field, const std::vector<uint8_t>& src);
+    void touchField(const void* dst) const;
+
+    // member pointer -> boundFields index, for the lazy getter path
+    std::unordered_map<const void*, size_t> lazySlots;
+
+    // One entry per subscribe() call: which format fields it wants and the
+    // callback that gets the per-frame intersection with the dirty set
+    struct Subscriber {
+        std::vector<bool> wants; // indexed by DataFormat field index
+        DataChangeCallback callback;
+        std::vector<uint16_t> scratch; // reused per-frame change list
+    };
+    std::vector<Subscriber> subscribers;
+    bool haveSubscriptions = false;
 
     std::vector<uint8_t> bytes;
+    std::vector<uint8_t> prevBytes;       // last unpacked frame, for dirty detection
+    std::vector<uint16_t> changedFields;  // scratch list of dirty field indices
     GPSData gpsOffset;
     std::vector<std::string> names;
     std::vector<int> byteNums;
     std::vector<std::string> types;
-    std::mutex mutex;
+    mutable std::mutex mutex;
     DataFetcher * fetcher;
+    BackendProcesses * retriever;
+    FrameRing * ring; // SPSC frame queue between fetcher and retriever
     
     // Helper method to trigger data change callbacks
     void notifyDataChanged();
@@ -0,0 +1,156 @@
+// Generated by tools/gen_format_layout.py from sc1-data-format/format.json
+// DO NOT EDIT BY HAND - rerun the generator after changing the data format.
+
+#ifndef DATAPROCESSOR_FORMATLAYOUT_H
+#define DATAPROCESSOR_FORMATLAYOUT_H
+
+#include <cstdint>
+
+namespace DataFormat {
+
+enum class FieldType : uint8_t {
+    Bool,
+    Uint8,
+    Uint16,
+    Uint64,
+    Float,
+    Double,
+    Char
+};
+
+struct FieldInfo {
+    const char* name;
+    uint32_t nameHash;  // FNV-1a of name, see fnv1a() below
+    uint16_t offset;    // byte offset of the field within a frame
+    uint8_t width;      // field width in bytes
+    FieldType type;
+};
+
+// 32-bit FNV-1a; constexpr so field lookups by name resolve at compile time.
+constexpr uint32_t fnv1a(const char* s) {
+    uint32_t h = 0x811C9DC5u;
+    while (*s) {
+        h ^= static_cast<uint8_t>(*s++);
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+inline constexpr int FIELD_COUNT = 80;
+inline constexpr int FRAME_SIZE = 202;
+
+inline constexpr FieldInfo FIELDS[FIELD_COUNT] = {
+    {"tstamp_hr", 0x66CABDE5u, 0, 1, FieldType::Uint8},
+    {"tstamp_mn", 0x78BE0E48u, 1, 1, FieldType::Uint8},
+    {"tstamp_sc", 0x55B05FA5u, 2, 1, FieldType::Uint8},
+    {"tstamp_ms", 0x65BDF05Fu, 3, 2, FieldType::Uint16},
+    {"tstamp_unix", 0x4E354939u, 5, 8, FieldType::Uint64},
+    {"speed", 0x7B80C780u, 13, 4, FieldType::Float},
+    {"accelerator_pedal", 0xA8DD401Fu, 17, 4, FieldType::Float},
+    {"crz_spd_setpt", 0xAEBEE06Bu, 21, 4, FieldType::Float},
+    {"crz_pwr_setpt", 0xAB5EB7C7u, 25, 4, FieldType::Float},
+    {"crz_spd_mode", 0xEFC39EE6u, 29, 1, FieldType::Bool},
+    {"crz_pwr_mode", 0xA56C4712u, 30, 1, FieldType::Bool},
+    {"eco", 0x8172C362u, 31, 1, FieldType::Bool},
+    {"parking_brake", 0x2CC0E93Bu, 32, 1, FieldType::Bool},
+    {"fan_speed", 0xAA49B9E2u, 33, 1, FieldType::Uint8},
+    {"state", 0x783132F6u, 34, 1, FieldType::Char},
+    {"headlights", 0xA0C6887Au, 35, 1, FieldType::Bool},
+    {"l_turn_led_en", 0x4B6674D1u, 36, 1, FieldType::Bool},
+    {"r_turn_led_en", 0x4793118Bu, 37, 1, FieldType::Bool},
+    {"hazards", 0x7F30063Au, 38, 1, FieldType::Bool},
+    {"soc", 0xDB36329Cu, 39, 4, FieldType::Float},
+    {"est_supplemental_soc", 0x4B0E03AAu, 43, 4, FieldType::Float},
+    {"mppt_current_out", 0xE42DBBA5u, 47, 4, FieldType::Float},
+    {"pack_voltage", 0x457913BDu, 51, 4, FieldType::Float},
+    {"pack_current", 0xF9976802u, 55, 4, FieldType::Float},
+    {"supplemental_voltage", 0xDE297DA6u, 59, 4, FieldType::Float},
+    {"bms_input_voltage", 0x8E577CFBu, 63, 4, FieldType::Float},
+    {"motor_power", 0x36550468u, 67, 4, FieldType::Float},
+    {"pack_temp", 0x789CEFFFu, 71, 4, FieldType::Float},
+    {"motor_temp", 0xA9CEDEF1u, 75, 4, FieldType::Float},
+    {"driverIO_temp", 0x8CB17A7Eu, 79, 4, FieldType::Float},
+    {"mainIO_temp", 0x02E13A6Bu, 83, 4, FieldType::Float},
+    {"cabin_temp", 0xEF003DD1u, 87, 4, FieldType::Float},
+    {"motor_controller_temp", 0x23AD500Au, 91, 4, FieldType::Float},
+    {"string1_temp", 0x66DBAF4Au, 95, 4, FieldType::Float},
+    {"string2_temp", 0x2A175F85u, 99, 4, FieldType::Float},
+    {"string3_temp", 0x0A5EC410u, 103, 4, FieldType::Float},
+    {"cell_group1_voltage", 0x49A00CBDu, 107, 4, FieldType::Float},
+    {"cell_group2_voltage", 0x83DA0960u, 111, 4, FieldType::Float},
+    {"cell_group3_voltage", 0x31CA4893u, 115, 4, FieldType::Float},
+    {"cell_group4_voltage", 0x93BDC9B6u, 119, 4, FieldType::Float},
+    {"cell_group5_voltage", 0xFD6390E1u, 123, 4, FieldType::Float},
+    {"cell_group6_voltage", 0x50D408D4u, 127, 4, FieldType::Float},
+    {"cell_group7_voltage", 0xBE0660A7u, 131, 4, FieldType::Float},
+    {"cell_group8_voltage", 0x68F28A9Au, 135, 4, FieldType::Float},
+    {"cell_group9_voltage", 0x47952085u, 139, 4, FieldType::Float},
+    {"cell_group10_voltage", 0x8E4E2B6Du, 143, 4, FieldType::Float},
+    {"cell_group11_voltage", 0xB3090BE2u, 147, 4, FieldType::Float},
+    {"cell_group12_voltage", 0x56D6E143u, 151, 4, FieldType::Float},
+    {"cell_group13_voltage", 0x74D9BBD0u, 155, 4, FieldType::Float},
+    {"cell_group14_voltage", 0x719BD3D1u, 159, 4, FieldType::Float},
+    {"lat", 0x5060769Eu, 163, 4, FieldType::Float},
+    {"lon", 0x36514326u, 167, 4, FieldType::Float},
+    {"elev", 0xB0892D7Fu, 171, 4, FieldType::Float},
+    {"mainIO_heartbeat", 0x185E1BCBu, 175, 1, FieldType::Bool},
+    {"main_telem", 0x9F99F450u, 176, 1, FieldType::Bool},
+    {"mc_status", 0x06A78D24u, 177, 1, FieldType::Uint8},
+    {"driver_eStop", 0xCD9ABEA7u, 178, 1, FieldType::Bool},
+    {"external_eStop", 0x8BE6B796u, 179, 1, FieldType::Bool},
+    {"crash", 0x1A4D55D8u, 180, 1, FieldType::Bool},
+    {"door", 0x21F5B729u, 181, 1, FieldType::Bool},
+    {"mcu_check", 0x71FBE2ABu, 182, 1, FieldType::Bool},
+    {"isolation", 0x383B2677u, 183, 1, FieldType::Bool},
+    {"bps_fault", 0xD60E64E3u, 184, 1, FieldType::Bool},
+    {"discharge_enable", 0xF84025F7u, 185, 1, FieldType::Bool},
+    {"charge_enable", 0x6AFE27B9u, 186, 1, FieldType::Bool},
+    {"bms_can_heartbeat", 0xDECEC00Fu, 187, 1, FieldType::Bool},
+    {"mcu_hv_en", 0x8A8D5153u, 188, 1, FieldType::Bool},
+    {"mcu_stat_fdbk", 0xD0DFE85Du, 189, 1, FieldType::Bool},
+    {"use_dcdc", 0x2675CD39u, 190, 1, FieldType::Bool},
+    {"supplemental_valid", 0x1726AB12u, 191, 1, FieldType::Bool},
+    {"mppt_contactor", 0x95C854DEu, 192, 1, FieldType::Bool},
+    {"low_contactor", 0x9000DF6Fu, 193, 1, FieldType::Bool},
+    {"motor_controller_contactor", 0x18E4EA7Du, 194, 1, FieldType::Bool},
+    {"voltage_failsafe", 0xB10ABADBu, 195, 1, FieldType::Bool},
+    {"current_failsafe", 0xE126FE96u, 196, 1, FieldType::Bool},
+    {"input_power_supply_failsafe", 0x729C85EBu, 197, 1, FieldType::Bool},
+    {"relay_failsafe", 0xCFA6D25Eu, 198, 1, FieldType::Bool},
+    {"cell_balancing_active", 0x20EC7078u, 199, 1, FieldType::Bool},
+    {"charge_interlock_failsafe", 0x8A043A69u, 200, 1, FieldType::Bool},
+    {"thermistor_b_value_table_invalid", 0x62FB2712u, 201, 1, FieldType::Bool},
+};
+
+// Index of a field by name, or -1 if the format does not contain it.
+constexpr int fieldIndex(const char* name) {
+    const uint32_t h = fnv1a(name);
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (FIELDS[i].nameHash == h) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Byte offset of a field by name, or -1 if the format does not contain it.
+constexpr int fieldOffset(const char* name) {
+    const int i = fieldIndex(name);
+    return i < 0 ? -1 : FIELDS[i].offset;
+}
+
+// Hash of the whole layout (names, offsets, widths). Both ends of a link can
+// compare this to check they were generated from the same format.json.
+constexpr uint32_t layoutHash() {
+    uint32_t h = 0x811C9DC5u;
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        h = (h ^ FIELDS[i].nameHash) * 0x01000193u;
+        h = (h ^ FIELDS[i].offset) * 0x01000193u;
+        h = (h ^ FIELDS[i].width) * 0x01000193u;
+    }
+    return h;
+}
+
+} // namespace DataFormat
+
+#endif // DATAPROCESSOR_FORMATLAYOUT_H
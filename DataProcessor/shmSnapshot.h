@@ -0,0 +1,132 @@
+#ifndef DATAPROCESSOR_SHMSNAPSHOT_H
+#define DATAPROCESSOR_SHMSNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "formatLayout.h"
+
+/**
+ * POSIX shared-memory snapshot of the decoded frame, guarded by a seqlock,
+ * published at the end of every unpack(). Local consumers (the Textual
+ * dashboard, debug tools) mmap /dev/shm/driver-io-snapshot and read a
+ * consistent snapshot with zero syscalls and zero copies: read seq, copy the
+ * values, re-read seq - equal and even means the copy is consistent.
+ *
+ * Segment layout (all little-endian, we only run on LE):
+ *   ShmSnapshotHeader
+ *   char names[fieldCount][NAME_LEN]   field table from format.json, written
+ *                                      once at creation
+ *   double values[fieldCount]          every field widened to a double
+ */
+
+struct ShmSnapshotHeader {
+    char magic[4];        // "BSHM"
+    uint32_t version;     // bump on layout change
+    uint32_t layoutHash;  // DataFormat::layoutHash() of the writing build
+    uint32_t fieldCount;
+    uint64_t seq;         // seqlock: odd = write in progress
+};
+
+class ShmSnapshot {
+public:
+    static constexpr const char* SEGMENT_NAME = "/driver-io-snapshot";
+    static constexpr size_t NAME_LEN = 48;
+
+    ShmSnapshot() {
+        size_t size = sizeof(ShmSnapshotHeader)
+                    + (size_t)DataFormat::FIELD_COUNT * NAME_LEN
+                    + (size_t)DataFormat::FIELD_COUNT * sizeof(double);
+        int fd = ::shm_open(SEGMENT_NAME, O_CREAT | O_RDWR, 0644);
+        if (fd < 0) {
+            return;
+        }
+        if (::ftruncate(fd, (off_t)size) != 0) {
+            ::close(fd);
+            return;
+        }
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping keeps the segment alive
+        if (map == MAP_FAILED) {
+            return;
+        }
+        base = (uint8_t*)map;
+        mappedBytes = size;
+
+        names = (char*)(base + sizeof(ShmSnapshotHeader));
+        values = (double*)(names + (size_t)DataFormat::FIELD_COUNT * NAME_LEN);
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            std::strncpy(names + (size_t)i * NAME_LEN, DataFormat::FIELDS[i].name, NAME_LEN - 1);
+        }
+
+        ShmSnapshotHeader header{};
+        std::memcpy(header.magic, "BSHM", 4);
+        header.version = 1;
+        header.layoutHash = DataFormat::layoutHash();
+        header.fieldCount = (uint32_t)DataFormat::FIELD_COUNT;
+        header.seq = 0;
+        std::memcpy(base, &header, sizeof(header));
+    }
+
+    ~ShmSnapshot() {
+        if (base != nullptr) {
+            ::munmap(base, mappedBytes);
+        }
+    }
+
+    ShmSnapshot(const ShmSnapshot&) = delete;
+    ShmSnapshot& operator=(const ShmSnapshot&) = delete;
+
+    bool available() const { return base != nullptr; }
+
+    // Decode every field of the frame into the segment under the seqlock.
+    void publish(const std::vector<uint8_t>& frame) {
+        if (base == nullptr || frame.size() < (size_t)DataFormat::FRAME_SIZE) {
+            return;
+        }
+        auto* seq = reinterpret_cast<std::atomic<uint64_t>*>(
+            base + offsetof(ShmSnapshotHeader, seq));
+        seq->fetch_add(1, std::memory_order_acquire); // now odd: write begins
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            values[i] = decodeField(frame, DataFormat::FIELDS[i]);
+        }
+        seq->fetch_add(1, std::memory_order_release); // even again: consistent
+    }
+
+private:
+    static double decodeField(const std::vector<uint8_t>& frame, const DataFormat::FieldInfo& f) {
+        switch (f.type) {
+            case DataFormat::FieldType::Float: {
+                float v;
+                std::memcpy(&v, frame.data() + f.offset, sizeof(v));
+                return v;
+            }
+            case DataFormat::FieldType::Double: {
+                double v;
+                std::memcpy(&v, frame.data() + f.offset, sizeof(v));
+                return v;
+            }
+            default: {
+                // integer/bool/char fields are little-endian in the frame
+                uint64_t v = 0;
+                for (int b = f.width - 1; b >= 0; b--) {
+                    v = (v << 8) | frame[f.offset + b];
+                }
+                return (double)v;
+            }
+        }
+    }
+
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    char* names = nullptr;
+    double* values = nullptr;
+};
+
+#endif // DATAPROCESSOR_SHMSNAPSHOT_H
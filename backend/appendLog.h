@@ -0,0 +1,108 @@
+#ifndef APPENDLOG_H
+#define APPENDLOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * Memory-mapped append-only segment log for the file-sync output path.
+ *
+ * Each segment is preallocated and mapped once, so an append on the hot path
+ * is a memcpy plus a pointer bump - no stream construction, no write() call,
+ * no once-a-minute flush stall. Dirty pages are flushed by the kernel at its
+ * own pace; msync(MS_ASYNC) is only issued when a segment closes. Segments
+ * rotate when full or after maxAgeMs, and are truncated to their written
+ * length on close so the sync consumer sees the same files as before.
+ */
+class AppendLog {
+public:
+    AppendLog(std::string directory, size_t segmentBytes = 4u << 20, long long maxAgeMs = 60000)
+        : directory(std::move(directory)), segmentBytes(segmentBytes), maxAgeMs(maxAgeMs) {}
+
+    ~AppendLog() {
+        closeSegment();
+    }
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    void append(const std::vector<uint8_t>& record) {
+        append(record.data(), record.size());
+    }
+
+    void append(const uint8_t* data, size_t len) {
+        if (len > segmentBytes) {
+            return; // a record can never span segments
+        }
+        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        if (base == nullptr || writePos + len > segmentBytes || now - segmentOpenedMs > maxAgeMs) {
+            closeSegment();
+            if (!openSegment(now)) {
+                return;
+            }
+        }
+        std::memcpy(base + writePos, data, len);
+        writePos += len;
+    }
+
+    uint64_t segmentsWritten() const { return segments; }
+
+private:
+    bool openSegment(long long now) {
+        // same naming as the old per-minute ofstream output
+        std::string path = directory + std::to_string(now) + "_all_bytes.bin";
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (::ftruncate(fd, (off_t)segmentBytes) != 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        void* map = ::mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        base = (uint8_t*)map;
+        writePos = 0;
+        segmentOpenedMs = now;
+        return true;
+    }
+
+    void closeSegment() {
+        if (base == nullptr) {
+            return;
+        }
+        ::msync(base, writePos, MS_ASYNC);
+        ::munmap(base, segmentBytes);
+        ::ftruncate(fd, (off_t)writePos); // drop the unwritten preallocated tail
+        ::close(fd);
+        base = nullptr;
+        fd = -1;
+        writePos = 0;
+        segments++;
+    }
+
+    std::string directory;
+    size_t segmentBytes;
+    long long maxAgeMs;
+
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t writePos = 0;
+    long long segmentOpenedMs = 0;
+    uint64_t segments = 0;
+};
+
+#endif // APPENDLOG_H
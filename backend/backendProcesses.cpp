@@ -1,5 +1,21 @@
 
 #include "backendProcesses.h"
+#include "backend/telemetrylib/binaryUplink.h"
+#include "backend/telemetrylib/sql.h"
+#include "backend/telemetrylib/udp.h"
+#include "Config.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/heartbeat.h"
+#include "backend/latencyStats.h"
+#include "backend/metrics.h"
+#include "backend/timebase.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
 
 double speedFunc(double t)
 {
@@ -18,12 +34,29 @@ double batteryFunc(double t)
 
 
 
-BackendProcesses::BackendProcesses(QByteArray &bytes, std::vector<std::string> &names, std::vector<std::string> &types, timestampOffsets timeDataOffsets, QMutex &mutex, int byteSize, QObject *parent) :
-    QObject(parent), bytes(bytes), names(names), types(types), mutex(mutex)
+// determine output path under the temp dir (should handle Unix and Win32 correctly)
+static std::string tempOutputPath(const char* name) {
+    std::string path = std::filesystem::temp_directory_path().string() + "/" + name + "/";
+    std::cout << path << std::endl;
+    if (!std::filesystem::exists(path)) {
+        std::filesystem::create_directory(path);
+    }
+    return path;
+}
+
+BackendProcesses::BackendProcesses(std::vector<uint8_t> &bytes, std::vector<std::string> &names, std::vector<std::string> &types, timestampOffsets timeDataOffsets, std::mutex &mutex, int byteSize, FrameRing &ring) :
+    bytes(bytes), names(names), types(types), mutex(mutex), ring(ring),
+    frameBuilder(byteSize, timeDataOffsets, DataFormat::layoutHash(),
+                 Config::getInstance().settings().frameCompression),
+    basePath(tempOutputPath("driver-io-file-sync")), syncLog(basePath),
+    historyLog(tempOutputPath("driver-io-telemetry-log"), (uint32_t)byteSize,
+               (uint32_t)timeDataOffsets.unix, DataFormat::layoutHash()),
+    columnLog(tempOutputPath("driver-io-column-log"), (uint32_t)timeDataOffsets.unix),
+    wal(tempOutputPath("driver-io-wal"), (uint32_t)(sizeof(long long) + byteSize),
+        DataFormat::layoutHash()),
+    framePool((size_t)byteSize),
+    blackBox(tempOutputPath("driver-io-blackbox"), byteSize, DataFormat::layoutHash())
 {
-    this->bytes = bytes;
-    this->names = names;
-    this->types = types;
     this->byteSize = byteSize;
 
     this->tstampOffsets.hr = timeDataOffsets.hr;
@@ -32,89 +65,210 @@ BackendProcesses::BackendProcesses(QByteArray &bytes, std::vector<std::string> &
     this->tstampOffsets.ms = timeDataOffsets.ms;
     this->tstampOffsets.unix = timeDataOffsets.unix;
 
-    // determine base path (should handle Unix and Win32 correctly)
-    basePath = QDir::tempPath() + "/driver-io-file-sync/";
-    qDebug() << basePath;
-    if (!QDir(basePath).exists()) {
-        QDir().mkdir(basePath);
+    if (Config::getInstance().settings().raceMode) {
+        // main already ran mlockall; touch the slab here so the first frames
+        // through the pool pay no faults either
+        framePool.prefault();
     }
+
+    // scrape-time samplers over counters the frame path already keeps; the
+    // scraper reads them on its own thread, this path pays nothing new
+    MetricsRegistry& metrics = MetricsRegistry::getInstance();
+    metrics.sampler("frame_ring_dropped_total", true,
+                    [this]() { return (int64_t)this->ring.droppedOldest(); });
+    metrics.sampler("frame_pool_in_use", false,
+                    [this]() { return (int64_t)framePool.inUse(); });
+    metrics.sampler("frame_pool_misses_total", true,
+                    [this]() { return (int64_t)framePool.misses(); });
 }
 
 void BackendProcesses::comm_status(bool s) {
-    emit eng_dash_connection(s);
+    notifyEngDashConnection(s);
 }
 
 void BackendProcesses::startThread() {
+    // Channel construction is local-only (the cloud handshakes - table
+    // create, uplink connect - happen lazily on each channel's worker at its
+    // first frame), so the drain loop below is live within microseconds of
+    // this thread starting; a slow cellular link delays nothing but its own
+    // channel's deliveries
     std::vector<DTI*> obj(2); //create a bunch of DTI instances and add them into this array in order of priority to be sent to telemetrylib
-    long long first_msec = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    long long first_msec = Timebase::wallMs();
+
+    // cloud sink: the binary protocol skips per-request HTTP overhead on the
+    // cellular link; HTTP stays the default until the server side speaks it
+    if (Config::getInstance().settings().uplinkMode == "binary") {
+        obj[0]=new BinaryUplink(std::to_string(first_msec));
+    } else {
+        obj[0]=new SQL(std::to_string(first_msec)); //This sends data to the cloud server
+    }
+    obj[1]=new UDP(Config::getInstance().settings().udpChasecarIp,
+               Config::getInstance().settings().udpChasecarPort); //This sends data to the chase car
 
-    obj[0]=new SQL(QString::fromStdString(std::to_string(first_msec))); //This sends data to the cloud server
-    obj[1]=new UDP(QHostAddress(Config::getInstance().getConfig()["udp_chasecar_ip"].toString()), 
-               Config::getInstance().getConfig()["udp_chasecar_port"].toInt()); //This sends data to the chase car
-    
     this->tel = new Telemetry(obj);
-    connect(this->tel, &Telemetry::eng_dash_connection, this, &BackendProcesses::comm_status); //for notifing the system connection status
+    tel->setEngDashConnectionCallback([this](bool s) { comm_status(s); }); //for notifing the system connection status
+
+    // replay frames a previous run logged but never got out: they re-enter
+    // the normal channel queues, so the SQL path re-uploads them while the
+    // freshness-bounded channels just keep the newest few
+    uint64_t replayFrom = wal.firstPending();
+    uint64_t replayTo = wal.lastWritten();
+    if (replayTo >= replayFrom && wal.valid()) {
+        std::cout << "WAL: replaying " << (replayTo - replayFrom + 1)
+                  << " frame(s) from a previous run" << std::endl;
+        uint64_t torn = 0;
+        for (uint64_t seq = replayFrom; seq <= replayTo; seq++) {
+            // a slot that fails its stamp is a torn tail from a crash mid
+            // group commit (or a stale lap); skip it rather than upload junk
+            if (!wal.verify(seq)) {
+                torn++;
+                continue;
+            }
+            const uint8_t* rec = wal.record(seq);
+            long long recTimestamp;
+            std::memcpy(&recTimestamp, rec, sizeof(recTimestamp));
+            std::vector<uint8_t> replayBytes(rec + sizeof(recTimestamp),
+                                             rec + sizeof(recTimestamp) + byteSize);
+            tel->sendData(framePool.makeFrame(replayBytes, recTimestamp), 0, seq);
+        }
+        if (torn > 0) {
+            std::cout << "WAL: skipped " << torn << " torn/stale record(s)" << std::endl;
+        }
+        lastWalAck = replayFrom - 1;
+    }
+
+    uint64_t nextStatsDump = LatencyStats::nowNs() + STATS_DUMP_INTERVAL_NS;
+
+    // drain frames as the fetch thread publishes them
+    std::unique_lock<std::mutex> lock(frameMutex);
+    while (!stop_flag) {
+        frameCv.wait_for(lock, std::chrono::milliseconds(100), [this] { return framePending || stop_flag; });
+        if (!framePending) {
+            continue;
+        }
+        framePending = false;
+        lock.unlock();
+        // drain everything queued since the last wakeup
+        while (!stop_flag && ring.pop(frameBuilder.buffer(), &frameIngressNs)) {
+            processFrame();
+        }
+        uint64_t droppedNow = ring.droppedOldest();
+        if (droppedNow != lastDropped) {
+            std::cout << "frame ring dropped " << (droppedNow - lastDropped)
+                      << " frame(s) (total " << droppedNow << ")" << std::endl;
+            lastDropped = droppedNow;
+        }
+        if (LatencyStats::nowNs() >= nextStatsDump) {
+            LatencyStats::getInstance().dump(std::cout);
+            std::cout << "frame pool: in use " << framePool.inUse()
+                      << ", high water " << framePool.highWater()
+                      << ", misses " << framePool.misses() << std::endl;
+            nextStatsDump = LatencyStats::nowNs() + STATS_DUMP_INTERVAL_NS;
+        }
+        lock.lock();
+    }
 }
 
 BackendProcesses::~BackendProcesses() {
-    stop=true; //tells the thread to stop
+    stop(); //tells the thread to stop
+}
+
+void BackendProcesses::start() {
+}
+
+void BackendProcesses::stop() {
+    stop_flag = true;
+    frameCv.notify_all();
 }
 
+// Called on the fetch thread when a new frame has been published. Just flags
+// the frame available; the actual timestamping/recording/sending runs on the
+// backend thread so a slow upload can never stall packet ingestion.
 void BackendProcesses::threadProcedure()
 {
-    if(stop) {
+    if(stop_flag) {
         return;
     }
 
+    bool wasPending;
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        wasPending = framePending;
+        framePending = true;
+    }
+    // if the flag was already up the backend is awake (or about to be) and
+    // will drain the ring anyway; skipping the wake saves a futex syscall on
+    // every frame that arrives while it's still working
+    if (!wasPending) {
+        frameCv.notify_one();
+    }
+}
+
+void BackendProcesses::processFrame()
+{
     //DataGen data(&speedFunc,&solarFunc,&batteryFunc,100);
 
-    mutex.lock();
+    // frame was already popped from the ring into the builder's buffer by
+    // startThread; the fetch thread is never blocked by anything below
+
+    // Get time data is received (then written to frame right after the frame is popped)
+    long long curr_msec = Timebase::wallMs();
 
-    // Get time data is received (then written to byte array right after byte array is updated/data is received)
-    auto curr_msec = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-    //time_t now = time(NULL);
-
-    uint8_t hour_time = (curr_msec/3600000 + 18) % 24;
-    //uint8_t hour_time = (gmtime(&now)->tm_hour + 18) % 24;
-    uint8_t min_time = (curr_msec/60000) % 60;
-    //uint8_t min_time = gmtime(&now)->tm_min;
-    uint8_t sec_time = (curr_msec/1000) % 60;
-    //uint8_t sec_time = gmtime(&now)->tm_sec;
-    uint16_t msec_time = curr_msec % 1000;
-    // Update timestamp in byte array
-    bytes.remove(tstampOffsets.hr,1);
-    bytes.insert(tstampOffsets.hr, hour_time & 0xFF);
-    bytes.remove(tstampOffsets.mn,1);
-    bytes.insert(tstampOffsets.mn, min_time & 0xFF);
-    bytes.remove(tstampOffsets.sc,1);
-    bytes.insert(tstampOffsets.sc, sec_time & 0xFF);
-    bytes.remove(tstampOffsets.ms,2);
-    bytes.insert(tstampOffsets.ms, (msec_time >> 8) & 0xFF);
-    bytes.insert(tstampOffsets.ms, msec_time & 0xFF);
-    bytes.remove(tstampOffsets.unix,8);
-    uint64_t time=curr_msec;
-    int mask= 56;
-    for(int i=0; i<=7; i++) {
-        bytes.insert(tstampOffsets.unix,(time>>mask) & 0xFF);
-        mask=mask-8;
+    static Heartbeat& heartbeat = PipelineWatchdog::getInstance().stage("backend");
+    heartbeat.beat();
+    static Counter& framesOut = MetricsRegistry::getInstance().counter("backend_frames_total");
+    framesOut.add();
+
+    // time from ethernet ingress to this frame reaching the backend thread
+    if (frameIngressNs != 0) {
+        static LatencyHistogram& toBackend = LatencyStats::getInstance().stage("ingress_to_backend");
+        toBackend.record(LatencyStats::nowNs() - frameIngressNs);
     }
-    // write byte array to file for sync, once a minute
-    static QByteArray all_bytes_in_minute = QByteArray();
-    all_bytes_in_minute.push_back("<bsr>");
-    all_bytes_in_minute.push_back(bytes);
-    all_bytes_in_minute.push_back("</bsr>");
-
-    // only output the file when our buffer has reached 
-    if (all_bytes_in_minute.size() >= 100000 || min_time != last_minute) {
-        std::ofstream(basePath.toStdString() + std::to_string(curr_msec) + "_all_bytes.bin", std::ios::binary)
-            .write(all_bytes_in_minute.data(), all_bytes_in_minute.size());
-        last_minute = min_time;
-        all_bytes_in_minute.clear();
+
+    // Update timestamp in frame, written in place - no element shifting
+    frameBuilder.stampTimestamps(curr_msec);
+
+    // record frame for file sync: the mmap log makes this a memcpy, with
+    // segment rotation and flushing handled off the frame path
+    syncRecord.clear();
+    frameBuilder.appendSyncRecord(syncRecord);
+    syncLog.append(syncRecord);
+
+    // record to the indexed history log for post-race replay
+    historyLog.append(frameBuilder.buffer().data());
+
+    // scatter into the columnar log so strategy queries can scan one field
+    // without decoding row blobs
+    columnLog.append(frameBuilder.buffer().data());
+
+    // black box: compressed circular record of everything, always on
+    blackBox.record(frameBuilder.buffer(), curr_msec);
+
+    // write-ahead: the frame is durable (group-committed) before any sink
+    // sees it, so a crash replays instead of losing the in-flight batch
+    walRecord.resize(sizeof(curr_msec) + frameBuilder.buffer().size());
+    std::memcpy(walRecord.data(), &curr_msec, sizeof(curr_msec));
+    std::memcpy(walRecord.data() + sizeof(curr_msec),
+                frameBuilder.buffer().data(), frameBuilder.buffer().size());
+    uint64_t walSeq = wal.append(walRecord.data());
+
+    // pooled buffer, shared by every channel: no allocation in steady state
+    FramePtr frame = framePool.makeFrame(frameBuilder.buffer(), curr_msec);
+    tel->sendData(frame, frameIngressNs, walSeq); //this passes the data to the telemetrylib to be sent to the chase car
+
+    // advance the WAL cursor to what every durable channel has pushed out
+    uint64_t acked = std::min(tel->ackedWalSeq(), walSeq);
+    if (acked > lastWalAck) {
+        wal.ackUpTo(acked);
+        lastWalAck = acked;
     }
 
-    // 60 lines of comments were removed here.
-    tel->sendData(bytes, curr_msec); //this passes the data to the telemetrylib to be sent to the chase car
+    // hand the timestamped frame to the unpacker: publish the snapshot under
+    // the shared mutex and poke the decode stage. The decode runs on its own
+    // thread, overlapping this frame's decode with the next frame's send and
+    // ingestion instead of serializing behind them.
+    mutex.lock();
+    bytes = frameBuilder.buffer();
     mutex.unlock();
-    emit dataReady();
+    notifyDataReady(frameIngressNs);
 }
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <thread>
 #include <functional>
@@ -13,31 +14,33 @@
 #include <string>
 #include <cstdint>
 
+#include "backend/appendLog.h"
+#include "backend/blackBox.h"
+#include "backend/framePool.h"
+#include "backend/walLog.h"
+#include "backend/frameBuilder.h"
+#include "backend/frameRing.h"
+#include "backend/columnLog.h"
+#include "backend/telemetryLog.h"
 #include "backend/telemetrylib/telemetry.h"
 #include "backend/telemetrylib/DTI.h"
 
-struct timestampOffsets {
-    int hr;
-    int mn;
-    int sc;
-    int ms;
-    int unix;
-};
-
 class BackendProcesses
 {
 public:
     // Callback types
     using EngDashConnectionCallback = std::function<void(bool state)>;
-    using DataReadyCallback = std::function<void()>;
+    // carries the frame's ingress timestamp so the decode stage can close
+    // the ingress-to-unpack latency measurement on its own thread
+    using DataReadyCallback = std::function<void(uint64_t ingressNs)>;
 
-    explicit BackendProcesses(std::vector<uint8_t> &bytes, std::vector<std::string> &names, std::vector<std::string> &types, timestampOffsets timeDataOffsets, std::mutex &mutex, int byteSize);
+    explicit BackendProcesses(std::vector<uint8_t> &bytes, std::vector<std::string> &names, std::vector<std::string> &types, timestampOffsets timeDataOffsets, std::mutex &mutex, int byteSize, FrameRing &ring);
     ~BackendProcesses();
 
     // Start and stop the backend processing
     void start();
     void stop();
-    
+
     // Set callbacks for events
     void setEngDashConnectionCallback(EngDashConnectionCallback callback) {
         engDashConnectionCallback = callback;
@@ -45,7 +48,7 @@ public:
     void setDataReadyCallback(DataReadyCallback callback) {
         dataReadyCallback = callback;
     }
-    
+
     // Interface methods (replacements for Qt slots)
     void threadProcedure();
     void startThread();
@@ -58,12 +61,15 @@ private:
             engDashConnectionCallback(state);
         }
     }
-    void notifyDataReady() {
+    void notifyDataReady(uint64_t ingressNs) {
         if (dataReadyCallback) {
-            dataReadyCallback();
+            dataReadyCallback(ingressNs);
         }
     }
 
+    // Timestamp, record and send one frame snapshot
+    void processFrame();
+
     timestampOffsets tstampOffsets;
     std::vector<uint8_t> &bytes;
     std::atomic<bool> stop_flag = false;
@@ -73,9 +79,18 @@ private:
     int byteSize;
     Telemetry* tel;
 
+    // Frame handoff from the fetch thread: the fetcher pushes into the ring
+    // and pokes frameCv; the backend thread drains every queued frame per
+    // wakeup, so the send path never holds a lock the fetcher needs.
+    FrameRing &ring;
+    FrameBuilder frameBuilder;
+    std::mutex frameMutex;
+    std::condition_variable frameCv;
+    bool framePending = false;
+
     // Threading
     std::thread processingThread;
-    
+
     // Callback functions
     EngDashConnectionCallback engDashConnectionCallback;
     DataReadyCallback dataReadyCallback;
@@ -83,11 +98,42 @@ private:
     // path of output directory used for file sync
     std::string basePath;
 
-    // timestamp when the last file sync output was written to disk
-    uint8_t last_minute = 0;
+    // mmap-backed segment log for file sync; appends are a pointer bump
+    AppendLog syncLog;
+
+    // indexed fixed-width history log for post-race replay queries
+    TelemetryLogWriter historyLog;
+
+    // columnar export for strategy analytics: single-field scans over the
+    // whole race without decoding row blobs
+    ColumnLogWriter columnLog;
+
+    // write-ahead log between this stage and the telemetry sinks: a crash
+    // replays whatever the durable channels hadn't pushed out yet
+    WriteAheadLog wal;
+
+    // recycled frame buffers: steady-state fan-out never hits the allocator
+    FramePool framePool;
+
+    // always-on compressed circular recorder; costs the frame path one
+    // ring push
+    BlackBox blackBox;
+
+    // scratch record reused across frames to avoid reallocating per frame
+    std::vector<uint8_t> syncRecord;
+    std::vector<uint8_t> walRecord;
+
+    // highest WAL sequence already acknowledged to the log
+    uint64_t lastWalAck = 0;
+
+    // drop count already reported on the console
+    uint64_t lastDropped = 0;
+
+    // ingress timestamp of the frame currently being processed (ring tag)
+    uint64_t frameIngressNs = 0;
 
-    // queued data for file sync
-    std::vector<uint8_t> all_bytes_in_minute;
+    // how often the latency histograms are dumped to the console
+    static constexpr uint64_t STATS_DUMP_INTERVAL_NS = 10ull * 1000 * 1000 * 1000;
 };
 
 #endif // BACKENDPROCESSES_H
@@ -0,0 +1,175 @@
+#include "blackBox.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+BlackBox::BlackBox(const std::string& directory, int frameSize, uint32_t layoutHash,
+                   size_t fileBytes, size_t slotBytes)
+    : frameSize(frameSize), layoutHash(layoutHash), slotBytes(slotBytes),
+      ring(frameSize + (int)sizeof(int64_t), 256) {
+    slotCount = fileBytes / slotBytes;
+    if (slotCount == 0) {
+        return;
+    }
+
+    std::string path = directory + "blackbox.bin";
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "BlackBox: could not open " << path << std::endl;
+        return;
+    }
+    if (::ftruncate(fd, (off_t)(slotCount * slotBytes)) != 0) {
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+
+    // recovery: resume after the highest valid segment a previous run left
+    SegmentHeader hdr{};
+    for (size_t slot = 0; slot < slotCount; slot++) {
+        if (::pread(fd, &hdr, sizeof(hdr), (off_t)(slot * slotBytes)) != sizeof(hdr)) {
+            break;
+        }
+        if (std::memcmp(hdr.magic, "BSEG", 4) == 0 && hdr.version == SEGMENT_VERSION &&
+            hdr.compressedBytes <= slotBytes - sizeof(hdr) && hdr.sequence >= nextSequence) {
+            nextSequence = hdr.sequence + 1;
+        }
+    }
+    if (nextSequence > 1) {
+        std::cout << "BlackBox: resuming at segment " << nextSequence << std::endl;
+    }
+
+    // flush when the raw buffer could still deflate into a slot even if the
+    // data turned out incompressible
+    rawTarget = slotBytes - sizeof(SegmentHeader) - slotBytes / 8;
+    rawBuf.reserve(rawTarget + sizeof(int64_t) + frameSize);
+    compressed.resize(compressBound((uLong)rawTarget + sizeof(int64_t) + frameSize));
+    popped.resize(sizeof(int64_t) + frameSize);
+
+    running = true;
+    writer = std::thread(&BlackBox::writerLoop, this);
+}
+
+BlackBox::~BlackBox() {
+    stop();
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void BlackBox::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    cv.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void BlackBox::record(const std::vector<uint8_t>& frame, long long timestamp) {
+    if (!running) {
+        return;
+    }
+    // one fixed-size ring slot: [int64 timestamp][frame]; the ring memcpys,
+    // so this allocates nothing and never blocks the frame path
+    uint8_t slot[sizeof(int64_t) + 512];
+    int64_t ts = (int64_t)timestamp;
+    size_t len = sizeof(ts) + frame.size();
+    if (len > sizeof(slot)) {
+        return;
+    }
+    std::memcpy(slot, &ts, sizeof(ts));
+    std::memcpy(slot + sizeof(ts), frame.data(), frame.size());
+    ring.push(slot, len);
+    // the writer drains in bulk and wakes on its own every 200 ms anyway, so
+    // one futex wake per WAKE_EVERY frames is plenty; at race rates that's a
+    // fraction of a second of extra buffering, well inside the ring's depth
+    if (++recordsSinceWake >= WAKE_EVERY) {
+        recordsSinceWake = 0;
+        cv.notify_one();
+    }
+}
+
+void BlackBox::writerLoop() {
+    std::unique_lock<std::mutex> lock(m);
+    while (running) {
+        cv.wait_for(lock, std::chrono::milliseconds(200));
+        lock.unlock();
+
+        while (ring.pop(popped)) {
+            int64_t ts;
+            std::memcpy(&ts, popped.data(), sizeof(ts));
+            if (segFrames == 0) {
+                segFirstTs = ts;
+            }
+            segLastTs = ts;
+            segFrames++;
+            rawBuf.insert(rawBuf.end(), popped.begin(), popped.end());
+            if (rawBuf.size() >= rawTarget) {
+                flushSegment();
+            }
+        }
+
+        lock.lock();
+    }
+    lock.unlock();
+    // final partial segment so a clean shutdown loses nothing
+    while (ring.pop(popped)) {
+        int64_t ts;
+        std::memcpy(&ts, popped.data(), sizeof(ts));
+        if (segFrames == 0) {
+            segFirstTs = ts;
+        }
+        segLastTs = ts;
+        segFrames++;
+        rawBuf.insert(rawBuf.end(), popped.begin(), popped.end());
+    }
+    flushSegment();
+}
+
+void BlackBox::flushSegment() {
+    if (segFrames == 0 || fd < 0) {
+        return;
+    }
+
+    uLongf outLen = (uLongf)compressed.size();
+    if (compress2(compressed.data(), &outLen, rawBuf.data(), (uLong)rawBuf.size(), 1) != Z_OK ||
+        outLen > slotBytes - sizeof(SegmentHeader)) {
+        // shouldn't happen with the rawTarget margin; drop the segment
+        // rather than corrupt a slot
+        rawBuf.clear();
+        segFrames = 0;
+        return;
+    }
+
+    SegmentHeader hdr{};
+    std::memcpy(hdr.magic, "BSEG", 4);
+    hdr.version = SEGMENT_VERSION;
+    hdr.sequence = nextSequence;
+    hdr.firstTimestamp = segFirstTs;
+    hdr.lastTimestamp = segLastTs;
+    hdr.frameCount = segFrames;
+    hdr.rawBytes = (uint32_t)rawBuf.size();
+    hdr.compressedBytes = (uint32_t)outLen;
+    hdr.crc32 = (uint32_t)::crc32(0, compressed.data(), (uInt)outLen);
+    hdr.layoutHash = layoutHash;
+
+    // data first, header last: the header is the commit record, so a crash
+    // between the two writes leaves the slot's previous lap valid
+    off_t slotOff = (off_t)(((nextSequence - 1) % slotCount) * slotBytes);
+    if (::pwrite(fd, compressed.data(), outLen, slotOff + sizeof(hdr)) == (ssize_t)outLen &&
+        ::pwrite(fd, &hdr, sizeof(hdr), slotOff) == (ssize_t)sizeof(hdr)) {
+        ::fdatasync(fd);
+        nextSequence++;
+        segmentsWritten.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    rawBuf.clear();
+    segFrames = 0;
+}
@@ -0,0 +1,99 @@
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend/frameRing.h"
+
+/**
+ * Always-on black-box recorder: a preallocated circular file of compressed
+ * frame segments sized to cover a full race day on SD-card storage.
+ *
+ * The hot path pays one ring push per frame; a dedicated writer thread
+ * accumulates frames into a raw segment buffer, deflates it (zlib level 1 -
+ * frames are mostly-unchanged fields, so even cheap compression bites hard)
+ * and commits it into the next slot of the circular file. Each slot starts
+ * with a header carrying a monotonic segment sequence, sizes and a checksum;
+ * the header is written after its data, so a crash mid-segment leaves the
+ * previous lap of that slot intact and recovery on boot just resumes after
+ * the highest valid sequence. Records inside a segment are
+ * [int64 timestamp ms][frame bytes].
+ */
+class BlackBox {
+public:
+    // fileBytes is rounded down to a whole number of slots; layoutHash is
+    // stamped into every segment so a recording is decodable even after
+    // format.json moves on
+    BlackBox(const std::string& directory, int frameSize, uint32_t layoutHash = 0,
+             size_t fileBytes = 2ull << 30, size_t slotBytes = 1u << 20);
+    ~BlackBox();
+
+    BlackBox(const BlackBox&) = delete;
+    BlackBox& operator=(const BlackBox&) = delete;
+
+    // Hot path: queue one timestamped frame for the writer thread. Never
+    // blocks; a stalled writer costs the oldest queued frames.
+    void record(const std::vector<uint8_t>& frame, long long timestamp);
+
+    void stop();
+
+    uint64_t segmentsCommitted() const { return segmentsWritten.load(std::memory_order_relaxed); }
+
+    // On-disk segment slot header; the slot is valid iff magic and version
+    // match and the sizes are sane. Shared with tools/blackbox_extract.
+    struct SegmentHeader {
+        char magic[4];           // "BSEG"
+        uint32_t version;
+        uint64_t sequence;       // monotonic across laps of the file
+        int64_t firstTimestamp;  // ms, first record in the segment
+        int64_t lastTimestamp;   // ms, last record
+        uint32_t frameCount;
+        uint32_t rawBytes;       // size before compression
+        uint32_t compressedBytes;
+        uint32_t crc32;          // of the compressed payload
+        uint32_t layoutHash;     // frame layout the segment was written under
+    };
+    static constexpr uint32_t SEGMENT_VERSION = 2;
+
+private:
+    void writerLoop();
+    void flushSegment();
+
+    const int frameSize;
+    const uint32_t layoutHash;
+    const size_t slotBytes;
+    size_t slotCount = 0;
+
+    int fd = -1;
+    uint64_t nextSequence = 1; // recovery scan moves this past old segments
+
+    // frame handoff: fetch-side push, writer-side drain. The producer only
+    // wakes the writer every WAKE_EVERY frames; the writer's own 200 ms
+    // periodic wakeup bounds the latency of a quiet stream.
+    static constexpr uint32_t WAKE_EVERY = 32;
+    uint32_t recordsSinceWake = 0; // producer-thread only
+    FrameRing ring;
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<bool> running{false};
+    std::thread writer;
+
+    // segment under construction (raw) and compression scratch
+    std::vector<uint8_t> rawBuf;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> popped;
+    size_t rawTarget = 0; // flush when rawBuf reaches this
+    int64_t segFirstTs = 0;
+    int64_t segLastTs = 0;
+    uint32_t segFrames = 0;
+
+    std::atomic<uint64_t> segmentsWritten{0};
+};
+
+#endif // BLACKBOX_H
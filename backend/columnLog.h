@@ -0,0 +1,248 @@
+#ifndef COLUMNLOG_H
+#define COLUMNLOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameCodec.h"
+
+/**
+ * Columnar export of the frame stream for strategy analytics: one contiguous,
+ * compressed column per format.json field, in time-partitioned segments.
+ *
+ * The row-oriented logs answer "give me the frames around time T" well, but
+ * "plot pack_current over the whole race" means decoding every field of every
+ * frame. Here a query touches exactly the columns it needs - timestamps plus
+ * the field - and scans them as flat arrays at memory bandwidth after one
+ * inflate. Columns of a single field are also far more self-similar than
+ * interleaved frames, so they deflate much harder than the row logs do.
+ *
+ * Segment layout (<firstTsMs>.bcol): ColumnLogHeader, then one uint32
+ * compressed-size per field, then the column blobs back to back in field
+ * order. A column whose compressed size equals rows*width is stored raw
+ * (deflate didn't shrink it). Column widths come from the compiled-in layout,
+ * guarded by the layout hash. All integers little-endian, like every other
+ * log here.
+ */
+
+struct ColumnLogHeader {
+    char magic[4];          // "BCOL"
+    uint32_t version;       // bump on layout change
+    uint32_t layoutHash;    // DataFormat::layoutHash() of the writing build
+    uint32_t fieldCount;    // columns in this segment
+    uint32_t rows;          // frames in this segment
+    uint32_t reserved;
+};
+
+class ColumnLogWriter {
+public:
+    // Segments rotate when they span windowMs of frame time; maxRows bounds
+    // the in-memory column buffers (and catches a wedged clock).
+    ColumnLogWriter(std::string directory, uint32_t tstampOffset,
+                    uint32_t windowMs = 60000, uint32_t maxRows = 8192)
+        : directory(std::move(directory)), tstampOffset(tstampOffset),
+          windowMs(windowMs), maxRows(maxRows), columns(DataFormat::FIELD_COUNT) {
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            columns[i].reserve((size_t)maxRows * DataFormat::FIELDS[i].width);
+        }
+    }
+
+    ~ColumnLogWriter() {
+        closeSegment();
+    }
+
+    ColumnLogWriter(const ColumnLogWriter&) = delete;
+    ColumnLogWriter& operator=(const ColumnLogWriter&) = delete;
+
+    // Scatter one frame into the column buffers: FIELD_COUNT short memcpys,
+    // no allocation in steady state. Rotation compresses and writes the
+    // segment; at one rotation per window that cost never shows up per frame.
+    void append(const uint8_t* frame) {
+        uint64_t ts;
+        std::memcpy(&ts, frame + tstampOffset, sizeof(ts));
+        if (rows == 0) {
+            firstTs = ts;
+        }
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            const DataFormat::FieldInfo& f = DataFormat::FIELDS[i];
+            columns[i].insert(columns[i].end(), frame + f.offset, frame + f.offset + f.width);
+        }
+        rows++;
+        if (ts - firstTs >= windowMs || rows >= maxRows) {
+            closeSegment();
+        }
+    }
+
+private:
+    void closeSegment() {
+        if (rows == 0) {
+            return;
+        }
+
+        std::vector<uint8_t> blob;
+        ColumnLogHeader header{};
+        std::memcpy(header.magic, "BCOL", 4);
+        header.version = 1;
+        header.layoutHash = DataFormat::layoutHash();
+        header.fieldCount = (uint32_t)DataFormat::FIELD_COUNT;
+        header.rows = rows;
+        blob.insert(blob.end(), (const uint8_t*)&header, (const uint8_t*)&header + sizeof(header));
+
+        // compress every column up front so the directory can be emitted
+        // before the blobs; raw fallback when deflate doesn't shrink
+        std::vector<uint32_t> sizes(DataFormat::FIELD_COUNT);
+        std::vector<std::vector<uint8_t>> packed(DataFormat::FIELD_COUNT);
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            size_t n = FrameCodec::compressPayload(columns[i].data(), columns[i].size(), packed[i]);
+            if (n == 0) {
+                packed[i] = columns[i];
+                n = columns[i].size();
+            } else {
+                packed[i].resize(n);
+            }
+            sizes[i] = (uint32_t)n;
+        }
+        blob.insert(blob.end(), (const uint8_t*)sizes.data(),
+                    (const uint8_t*)sizes.data() + sizes.size() * sizeof(uint32_t));
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            blob.insert(blob.end(), packed[i].begin(), packed[i].end());
+        }
+
+        // write-then-rename so readers only ever see complete segments
+        std::string path = directory + std::to_string(firstTs) + ".bcol";
+        std::string tmpPath = path + ".tmp";
+        int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            ssize_t written = ::write(fd, blob.data(), blob.size());
+            ::close(fd);
+            if (written == (ssize_t)blob.size()) {
+                ::rename(tmpPath.c_str(), path.c_str());
+            } else {
+                ::unlink(tmpPath.c_str());
+            }
+        }
+
+        for (auto& column : columns) {
+            column.clear(); // capacity stays reserved
+        }
+        rows = 0;
+    }
+
+    std::string directory;
+    uint32_t tstampOffset;
+    uint32_t windowMs;
+    uint32_t maxRows;
+
+    std::vector<std::vector<uint8_t>> columns; // one buffer per field
+    uint32_t rows = 0;
+    uint64_t firstTs = 0;
+};
+
+class ColumnLogReader {
+public:
+    ColumnLogReader() = default;
+
+    ~ColumnLogReader() {
+        close();
+    }
+
+    ColumnLogReader(const ColumnLogReader&) = delete;
+    ColumnLogReader& operator=(const ColumnLogReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ColumnLogHeader)) {
+            close();
+            return false;
+        }
+        mappedBytes = (size_t)st.st_size;
+        void* map = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base = (const uint8_t*)map;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, "BCOL", 4) != 0 || header.version != 1 ||
+            header.layoutHash != DataFormat::layoutHash() ||
+            header.fieldCount != (uint32_t)DataFormat::FIELD_COUNT) {
+            // widths come from this build's layout; a segment from another
+            // format.json can't be decoded with them
+            close();
+            return false;
+        }
+        size_t dirBytes = (size_t)header.fieldCount * sizeof(uint32_t);
+        if (mappedBytes < sizeof(header) + dirBytes) {
+            close();
+            return false;
+        }
+        offsets.resize(header.fieldCount);
+        size_t at = sizeof(header) + dirBytes;
+        for (uint32_t i = 0; i < header.fieldCount; i++) {
+            uint32_t csize;
+            std::memcpy(&csize, base + sizeof(header) + i * sizeof(uint32_t), sizeof(csize));
+            offsets[i] = {at, csize};
+            at += csize;
+        }
+        if (at > mappedBytes) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) {
+            ::munmap((void*)base, mappedBytes);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        offsets.clear();
+    }
+
+    uint32_t rows() const { return header.rows; }
+    const ColumnLogHeader& segmentHeader() const { return header; }
+
+    /**
+     * Inflate one field's column into `out` (rows * width bytes, values back
+     * to back in row order). False on a corrupt column.
+     */
+    bool column(int fieldIndex, std::vector<uint8_t>& out) const {
+        if (fieldIndex < 0 || fieldIndex >= (int)header.fieldCount) {
+            return false;
+        }
+        size_t raw = (size_t)header.rows * DataFormat::FIELDS[fieldIndex].width;
+        out.resize(raw);
+        const auto& [offset, csize] = offsets[fieldIndex];
+        if ((size_t)csize == raw) {
+            std::memcpy(out.data(), base + offset, raw); // stored raw
+            return true;
+        }
+        return FrameCodec::decompressPayload(base + offset, csize, out.data(), raw) == raw;
+    }
+
+private:
+    int fd = -1;
+    const uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    ColumnLogHeader header{};
+    std::vector<std::pair<size_t, uint32_t>> offsets; // per column: (file offset, compressed size)
+};
+
+#endif // COLUMNLOG_H
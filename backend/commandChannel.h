@@ -0,0 +1,152 @@
+#ifndef COMMANDCHANNEL_H
+#define COMMANDCHANNEL_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+/**
+ * Low-latency command path back to the boards.
+ *
+ * Telemetry flows board -> vehicle on the ingest sockets; commands ride the
+ * same sockets in the other direction, where they are the only outbound
+ * traffic. The channel keeps a small priority-ordered queue of in-flight
+ * commands: posting is thread-safe and cheap, the fetch thread pumps the
+ * queue ahead of anything else when its eventfd fires, and every command is
+ * retransmitted on a short timer until a board acknowledges its sequence
+ * number or the attempt budget runs out. With TCP_NODELAY on the sockets the
+ * first copy of a restart-enable hits the wire within the epoll wakeup
+ * instead of a Nagle window later.
+ *
+ * Wire format, vehicle -> board: "<cmd>" + opcode (u8) + sequence (u16 LE) +
+ * "</cmd>". Acks come back inside the normal frame framing as a 5-byte
+ * record "ACK" + sequence, which both parser modes hand out as a short
+ * frame for DataFetcher::handleFrame() to intercept.
+ */
+class CommandChannel {
+public:
+    // Command opcodes understood by the boards
+    static constexpr uint8_t RESTART_ENABLE = 0x01;
+
+    // "ACK" + uint16 sequence, carried as a short framed record
+    static constexpr size_t ACK_BYTES = 3 + sizeof(uint16_t);
+
+    // "<cmd>" + opcode + uint16 sequence + "</cmd>"
+    static constexpr size_t CMD_BYTES = 5 + 1 + sizeof(uint16_t) + 6;
+
+    /**
+     * Queue a command and return the sequence number assigned to it. Higher
+     * priority sorts ahead; equal priority keeps post order. Callable from
+     * any thread; the caller is responsible for waking the pumping thread.
+     */
+    uint16_t post(uint8_t opcode, uint8_t priority = PRIORITY_URGENT) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint16_t seq = nextSeq++;
+        Pending cmd{opcode, priority, seq, 0, 0};
+        auto at = queue.end();
+        while (at != queue.begin() && (at - 1)->priority < priority) {
+            --at;
+        }
+        queue.insert(at, cmd);
+        posted++;
+        return seq;
+    }
+
+    // True while anything is in flight; the pumping thread shortens its
+    // poll timeout so retransmit deadlines are honored
+    bool busy() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !queue.empty();
+    }
+
+    /**
+     * Drive the queue: send every command whose first transmission or
+     * retransmit is due, drop any that exhausted the attempt budget.
+     * send(data, len) writes one encoded command to the wire; it is invoked
+     * in queue order, so urgent commands always go first.
+     */
+    template <typename Send>
+    void pump(uint64_t nowNs, Send&& send) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (it->lastSentNs != 0 && nowNs - it->lastSentNs < RETRY_NS) {
+                ++it;
+                continue;
+            }
+            if (it->attempts >= MAX_ATTEMPTS) {
+                std::cout << "CommandChannel: command 0x" << std::hex << (int)it->opcode
+                          << std::dec << " seq " << it->seq << " unacknowledged after "
+                          << it->attempts << " attempt(s), giving up" << std::endl;
+                dropped++;
+                it = queue.erase(it);
+                continue;
+            }
+            uint8_t wire[CMD_BYTES];
+            encode(wire, it->opcode, it->seq);
+            send(wire, sizeof(wire));
+            if (it->attempts > 0) {
+                retransmitted++;
+            }
+            it->attempts++;
+            it->lastSentNs = nowNs;
+            ++it;
+        }
+    }
+
+    // Ack from a board; true if the sequence matched an in-flight command
+    // (a retransmit can earn a duplicate ack, which lands here as false)
+    bool acknowledge(uint16_t seq) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->seq == seq) {
+                queue.erase(it);
+                acked++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t postedCount() const { return posted; }
+    uint64_t ackedCount() const { return acked; }
+    uint64_t retransmitCount() const { return retransmitted; }
+    uint64_t droppedCount() const { return dropped; }
+
+private:
+    // restart-enable class commands; telemetry-rate housekeeping would post
+    // at a lower value and queue behind them
+    static constexpr uint8_t PRIORITY_URGENT = 255;
+
+    // retransmit a command every 50 ms, give up after 10 tries (half a
+    // second of a board not listening means it is rebooting or gone)
+    static constexpr uint64_t RETRY_NS = 50ull * 1000 * 1000;
+    static constexpr int MAX_ATTEMPTS = 10;
+
+    static void encode(uint8_t* out, uint8_t opcode, uint16_t seq) {
+        std::memcpy(out, "<cmd>", 5);
+        out[5] = opcode;
+        std::memcpy(out + 6, &seq, sizeof(seq));
+        std::memcpy(out + 8, "</cmd>", 6);
+    }
+
+    struct Pending {
+        uint8_t opcode;
+        uint8_t priority;
+        uint16_t seq;
+        uint64_t lastSentNs; // 0 until the first transmission
+        int attempts;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Pending> queue; // priority-ordered, urgent first
+    uint16_t nextSeq = 1;
+
+    uint64_t posted = 0;
+    uint64_t acked = 0;
+    uint64_t retransmitted = 0;
+    uint64_t dropped = 0;
+};
+
+#endif // COMMANDCHANNEL_H
@@ -1,127 +1,355 @@
 #include "dataFetcher.h"
 #include "Config.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/heartbeat.h"
+#include "backend/latencyStats.h"
+#include "backend/metrics.h"
+#include "backend/timebase.h"
 
-DataFetcher::DataFetcher(QByteArray &bytes, int byteSize, QMutex &mutex, GPSData gpsOffset, QObject *parent) :
-    QObject(parent), bytes(bytes), byteSize(byteSize), mutex(mutex) {
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+DataFetcher::DataFetcher(FrameRing &ring, int byteSize, GPSData gpsOffset, int speedOffset) :
+    ring(ring), byteSize(byteSize), speedOffset(speedOffset) {
         // initialize GPS
         gps = new GPS();
         #ifdef  __linux__
-            gps->moveToThread(&gpsThread);
-            connect(&gpsThread, &QThread::finished, gps, &QObject::deleteLater);
-            connect(&gpsThread, &QThread::started, gps, &GPS::autoInit);
-            gpsThread.start();
+            // autoInit probes devices forever, so the thread is detached;
+            // it dies with the process
+            gpsThread = std::thread(&GPS::autoInit, gps);
+            gpsThread.detach();
         #endif
         this->gpsOffset = gpsOffset;
     }
 
 void DataFetcher::startThread() {
+    running = true;
     threadProcedure();
 }
 
 DataFetcher::~DataFetcher() {
+    stop();
+}
+
+void DataFetcher::start() {
+    running = true;
+}
+
+void DataFetcher::stop() {
+    // Only flag and wake: `sources` belongs to the epoll thread (accepts and
+    // drops mutate it concurrently), so touching it from the caller here
+    // races on every shutdown and watchdog kick. The loop notices `running`
+    // on its next wakeup and closes the per-source fds itself at exit.
+    running = false;
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ::write(wakeFd, &one, sizeof(one));
+    }
+    if (listenFd >= 0) {
+        ::shutdown(listenFd, SHUT_RDWR);
+    }
 }
 
 void DataFetcher::threadProcedure()
 {
     // setup server
-    ethServer = new QTcpServer;
-    QHostAddress addr(QHostAddress::AnyIPv4);
-    // print ip and port
-    int ipPort = Config::getInstance().getConfig()["EthernetPort"].toInt();
-    
-    ethServer->listen(addr, ipPort);
-
-    connect(ethServer, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
-}
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "DataFetcher: could not create server socket" << std::endl;
+        return;
+    }
+    int opt = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
-void DataFetcher::onNewConnection() {
-    if (ethServer->hasPendingConnections()) {
-        clientSocket = ethServer->nextPendingConnection();
-        connected = true;
-        clientSocket->write("Connection received");
-        connect(clientSocket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
-        connect(clientSocket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    int ipPort = Config::getInstance().settings().ethernetPort;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(ipPort);
+
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, 4) < 0) {
+        std::cerr << "DataFetcher: could not listen on port " << ipPort << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return;
     }
-}
 
-void insertFloat(QByteArray &data, float value, int offset) {
-    QByteArray floatData;
-    floatData.append(reinterpret_cast<const char*>(&value), sizeof(float));
-    data.replace(offset, sizeof(float), floatData);
+    // One epoll over the listen socket and every connected source: multiple
+    // boards push concurrently, each with its own framing state, and none of
+    // them can monopolize the thread or wedge ingestion by reconnecting.
+    epollFd = ::epoll_create1(0);
+    if (epollFd < 0) {
+        std::cerr << "DataFetcher: epoll_create1 failed" << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+
+    // sendCommand() pokes this eventfd so a queued command interrupts the
+    // epoll wait instead of riding out the remainder of its timeout
+    wakeFd = ::eventfd(0, EFD_NONBLOCK);
+    if (wakeFd >= 0) {
+        epoll_event wev{};
+        wev.events = EPOLLIN;
+        wev.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wev);
+    }
+
+    epoll_event events[16];
+    while (running) {
+        // with commands in flight, wake often enough to hit their 50 ms
+        // retransmit deadlines; otherwise the usual shutdown-check cadence
+        int n = ::epoll_wait(epollFd, events, 16, commands.busy() ? 20 : 500);
+        // commands go out before any bulk work on this wakeup - a pending
+        // restart-enable never waits behind a burst of telemetry reads
+        pumpCommands();
+        for (int i = 0; i < n && running; i++) {
+            if (events[i].data.fd == listenFd) {
+                acceptSources();
+                continue;
+            }
+            if (events[i].data.fd == wakeFd) {
+                uint64_t drained;
+                while (::read(wakeFd, &drained, sizeof(drained)) > 0) {}
+                continue; // already pumped above, ahead of the source reads
+            }
+            // find the source for this fd; dropSource may have removed it
+            // for an earlier event in the same batch
+            for (auto& source : sources) {
+                if (source->fd == events[i].data.fd) {
+                    if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                        dropSource(source->fd);
+                    } else {
+                        readSource(*source);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    while (!sources.empty()) {
+        dropSource(sources.front()->fd);
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+    close(epollFd);
+    epollFd = -1;
+    close(listenFd);
+    listenFd = -1;
 }
 
-void DataFetcher::onReadyRead() {
-    QByteArray buffer;
-    QByteArray newData;
+void DataFetcher::acceptSources() {
+    // one accept per wakeup; epoll is level-triggered, so a second pending
+    // connection just fires the listen fd again
+    int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    // commands ride this socket back to the board; without this their
+    // 14-byte writes would sit out a Nagle window behind nothing
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    const char greeting[] = "Connection received";
+    ::send(fd, greeting, sizeof(greeting) - 1, MSG_NOSIGNAL);
+
+    // announce our format identity: "<fmt>" + layoutHash + "</fmt>". A
+    // source built against the same format.json echoes the same message as
+    // its first bytes and gets rejected on mismatch; older boards that send
+    // nothing are taken on faith, as before.
+    uint8_t fmtMsg[FMT_MSG_BYTES];
+    uint32_t hash = DataFormat::layoutHash();
+    memcpy(fmtMsg, "<fmt>", 5);
+    memcpy(fmtMsg + 5, &hash, sizeof(hash));
+    memcpy(fmtMsg + 9, "</fmt>", 6);
+    ::send(fd, fmtMsg, sizeof(fmtMsg), MSG_NOSIGNAL);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        close(fd);
+        return;
+    }
+    sources.push_back(std::make_unique<Source>(fd, byteSize, DataFormat::layoutHash()));
+    static Gauge& connected = MetricsRegistry::getInstance().gauge("fetch_sources_connected");
+    connected.set((int64_t)sources.size());
+    std::cout << "DataFetcher: source fd " << fd << " connected ("
+              << sources.size() << " active)" << std::endl;
+}
 
-    QString startTag = "<bsr>";
-    QString endTag = "</bsr>";
+void insertFloat(uint8_t *data, float value, int offset) {
+    memcpy(data + offset, &value, sizeof(float));
+}
 
-    // continuously get datastream from client as QByteArray
-    while (connected) {
-        newData = clientSocket->readAll();
+void DataFetcher::readSource(Source& source) {
+    // Fixed read buffer; every received byte goes through this source's
+    // incremental framing parser exactly once, with complete frames handed
+    // to handleFrame() as views into the parser's buffer.
+    uint8_t buf[4096];
 
-        // if no data then wait and try again
-        while (connected && (newData.isEmpty() || !newData.contains(startTag.toUtf8()))) {
-            if(!clientSocket->waitForReadyRead(3000)) {
-                onDisconnected();
-                return;  // Exit the function if disconnected
+    while (true) {
+        ssize_t n = ::recv(source.fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                dropSource(source.fd);
             }
-            newData = clientSocket->readAll();
+            return; // drained; epoll will wake us for the next burst
+        }
+        if (n == 0) {
+            dropSource(source.fd);
+            return;
         }
 
-        // remove starting tag of data packet
-        int startTagIndex = newData.indexOf(startTag.toUtf8());
-        newData.remove(0, startTagIndex + startTag.size());
+        // ingress anchor for the end-to-end latency histograms: every frame
+        // completed out of this read inherits the read's arrival time
+        ingressNs = LatencyStats::nowNs();
 
-        // keep getting data until the end tag is reached
-        while (connected && !newData.contains(endTag.toUtf8())) {
-            buffer.append(newData);
-            if(!clientSocket->waitForReadyRead(3000)) {
-                onDisconnected();
-                return;  // Exit the function if disconnected
+        uint8_t* bytes = buf;
+        if (!source.fmtChecked) {
+            // a schema-aware source leads with its own format announcement;
+            // it arrives well inside the first read in practice
+            source.fmtChecked = true;
+            if (n >= (ssize_t)FMT_MSG_BYTES && memcmp(bytes, "<fmt>", 5) == 0 &&
+                memcmp(bytes + 9, "</fmt>", 6) == 0) {
+                uint32_t theirs;
+                memcpy(&theirs, bytes + 5, sizeof(theirs));
+                if (theirs != DataFormat::layoutHash()) {
+                    std::cout << "DataFetcher: source fd " << source.fd
+                              << " speaks a different format (theirs " << std::hex << theirs
+                              << ", ours " << DataFormat::layoutHash() << std::dec
+                              << "), rejecting" << std::endl;
+                    dropSource(source.fd);
+                    return;
+                }
+                bytes += FMT_MSG_BYTES;
+                n -= FMT_MSG_BYTES;
             }
-            newData = clientSocket->readAll();
         }
 
-        // remove the end tag
-        int endTagIndex = newData.indexOf(endTag.toUtf8());
-        newData.remove(endTagIndex, endTag.size());
+        source.parser.consume(bytes, n, [this, &source](uint8_t* data, size_t len) {
+            handleFrame(source, data, len);
+        });
 
-        // append the remaining data from buffer
-        newData.prepend(buffer);
-        buffer.clear();
+        // a v2 source declares its layout in every record header; a mismatch
+        // means this board was built against a different format.json
+        if (source.parser.layoutMismatches() > 0) {
+            std::cout << "DataFetcher: source fd " << source.fd
+                      << " sends frames from a different format layout, rejecting" << std::endl;
+            dropSource(source.fd);
+            return;
+        }
+    }
+}
 
-        // check if newData is a corrupted packet
-        if (newData.size() != byteSize) {
-            continue;
+void DataFetcher::dropSource(int fd) {
+    for (auto it = sources.begin(); it != sources.end(); ++it) {
+        if ((*it)->fd == fd) {
+            const FramingParser& parser = (*it)->parser;
+            std::cout << "DataFetcher: source fd " << fd << " disconnected after "
+                      << (*it)->frames << " frame(s)";
+            if (parser.resyncCount() > 0 || parser.oversizedDropped() > 0 ||
+                parser.crcFailures() > 0) {
+                std::cout << "; corruption: " << parser.resyncCount() << " resync(s), "
+                          << parser.bytesDiscarded() << " byte(s) discarded, largest gap "
+                          << parser.largestGapBytes() << ", " << parser.oversizedDropped()
+                          << " oversized frame(s), " << parser.crcFailures()
+                          << " checksum failure(s)";
+            }
+            std::cout << std::endl;
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            sources.erase(it);
+            static Gauge& connected = MetricsRegistry::getInstance().gauge("fetch_sources_connected");
+            connected.set((int64_t)sources.size());
+            return;
         }
+    }
+}
 
-        // fill gps data with the offset
-        GPSData gpsData = gps->getLoc();
-        // insert into byte array
-        // if no gps device, pass through the generated data
-        if (gps->initialized()) {
-            insertFloat(newData, gpsData.lat, (int)gpsOffset.lat);
-            insertFloat(newData, gpsData.lon, (int)gpsOffset.lon);
-            insertFloat(newData, gpsData.alt, (int)gpsOffset.alt);
+void DataFetcher::handleFrame(Source& source, uint8_t* data, size_t len) {
+    // a short "ACK" + sequence record is a board acknowledging a command,
+    // not a corrupt frame
+    if (len == CommandChannel::ACK_BYTES && memcmp(data, "ACK", 3) == 0) {
+        uint16_t seq;
+        memcpy(&seq, data + 3, sizeof(seq));
+        if (commands.acknowledge(seq)) {
+            std::cout << "DataFetcher: source fd " << source.fd
+                      << " acked command seq " << seq << std::endl;
         }
-        mutex.lock();
-        this->bytes = newData;
-        mutex.unlock();
+        return;
+    }
+
+    // check if packet is corrupted
+    if ((int)len != byteSize) {
+        return;
+    }
+    source.frames++;
+    static Heartbeat& heartbeat = PipelineWatchdog::getInstance().stage("fetch");
+    heartbeat.beat();
+    static Counter& framesIn = MetricsRegistry::getInstance().counter("fetch_frames_total");
+    framesIn.add();
 
-        // emit dataFetched signal to backend processes thread procedure
-        emit dataFetched();
-        QCoreApplication::processEvents();
+    // fill gps data with the offset, patched in place in the parser's buffer
+    GPSData gpsData = gps->getLoc();
+    // if no gps device, pass through the generated data
+    if (gps->initialized()) {
+        // dead-reckon between 1 Hz fixes using the frame's decoded speed,
+        // so consecutive frames don't all repeat the same stale coordinate;
+        // frames carrying a real fix snap back to the raw measurement
+        float frameSpeed;
+        memcpy(&frameSpeed, data + speedOffset, sizeof(frameSpeed));
+        GPSData est = estimator.apply(gpsData, frameSpeed, Timebase::wallMs());
+        insertFloat(data, est.lat, (int)gpsOffset.lat);
+        insertFloat(data, est.lon, (int)gpsOffset.lon);
+        insertFloat(data, est.alt, (int)gpsOffset.alt);
     }
+
+    // enqueue for the backend thread; never blocks, drops oldest if full.
+    // the ingress timestamp rides along as the slot tag
+    ring.push(data, len, ingressNs);
+
+    // wake the backend processes thread
+    notifyDataFetched();
 }
 
-void DataFetcher::onDisconnected() {
-    connected = false;
-    clientSocket->deleteLater();
+void DataFetcher::sendData(const std::vector<uint8_t>& data) {
+    for (auto& source : sources) {
+        ::send(source->fd, data.data(), data.size(), MSG_NOSIGNAL);
+    }
 }
 
-void DataFetcher::sendData(QByteArray data) {
-    if(connected)
-        clientSocket->write(data);
+void DataFetcher::sendCommand(uint8_t opcode) {
+    uint16_t seq = commands.post(opcode);
+    std::cout << "DataFetcher: command 0x" << std::hex << (int)opcode << std::dec
+              << " queued as seq " << seq << std::endl;
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ::write(wakeFd, &one, sizeof(one));
+    }
+}
+
+void DataFetcher::pumpCommands() {
+    commands.pump(LatencyStats::nowNs(), [this](const uint8_t* data, size_t len) {
+        // broadcast like sendData: the addressed board acks, the rest
+        // ignore the opcode
+        for (auto& source : sources) {
+            ::send(source->fd, data, len, MSG_NOSIGNAL);
+        }
+    });
 }
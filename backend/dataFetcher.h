@@ -2,12 +2,17 @@
 #define DATAFETCHER_H
 
 #include <vector>
-#include <mutex>
+#include <string>
+#include <memory>
 #include <thread>
 #include <atomic>
 #include <functional>
 #include <cstdint>
+#include "backend/commandChannel.h"
+#include "backend/frameRing.h"
+#include "backend/framingParser.h"
 #include "gps/gps.h"
+#include "gps/positionEstimator.h"
 
 class DataFetcher
 {
@@ -15,27 +20,45 @@ public:
     // Callback type for data fetched events
     using DataFetchedCallback = std::function<void()>;
 
-    explicit DataFetcher(std::vector<uint8_t> &bytes, int byteSize, std::mutex &mutex, GPSData gpsOffset);
+    explicit DataFetcher(FrameRing &ring, int byteSize, GPSData gpsOffset, int speedOffset);
     ~DataFetcher();
 
     // Start and stop data fetching
     void start();
     void stop();
-    
+
     // Set callback for data fetched events
     void setDataFetchedCallback(DataFetchedCallback callback) {
         dataFetchedCallback = callback;
     }
-    
+
     // Interface methods (replacements for Qt slots)
     void threadProcedure();
     void startThread();
-    void onNewConnection();
-    void onReadyRead();
-    void onDisconnected();
     void sendData(const std::vector<uint8_t>& data);
 
+    // Queue a command for the boards and wake the fetch thread so it goes
+    // out immediately; retransmitted until acked (see backend/commandChannel.h)
+    void sendCommand(uint8_t opcode);
+
 private:
+    /**
+     * One connected data source (main I/O board, BMS bridge, simulator...).
+     * Each keeps its own framing state so interleaved streams can never
+     * corrupt each other, plus a frame count for the disconnect log line.
+     */
+    struct Source {
+        int fd;
+        FramingParser parser;
+        uint64_t frames = 0;
+        bool fmtChecked = false; // leading format announcement handled
+        Source(int fd, int byteSize, uint32_t layoutHash)
+            : fd(fd), parser((size_t)byteSize, layoutHash) {}
+    };
+
+    // "<fmt>" + uint32 layout hash + "</fmt>", exchanged at connect
+    static constexpr size_t FMT_MSG_BYTES = 5 + sizeof(uint32_t) + 6;
+
     // Helper method to notify data fetched
     void notifyDataFetched() {
         if (dataFetchedCallback) {
@@ -43,21 +66,43 @@ private:
         }
     }
 
-    std::vector<uint8_t> &bytes;
+    // epoll event handlers
+    void acceptSources();
+    void readSource(Source& source);
+    void dropSource(int fd);
+
+    // Handle one complete frame emitted by a source's framing parser
+    void handleFrame(Source& source, uint8_t* data, size_t len);
+
+    // Broadcast due command (re)transmissions to every connected source
+    void pumpCommands();
+
+    FrameRing &ring;
+
+    // arrival time of the read currently being parsed, for latency stats
+    uint64_t ingressNs = 0;
     int byteSize;
-    std::mutex &mutex;
-    std::atomic<bool> connected = false;
     std::atomic<bool> running = false;
-    std::thread* thread;
+
+    // Server socket plus one entry per connected source, all on one epoll
+    int listenFd = -1;
+    int epollFd = -1;
+    std::vector<std::unique_ptr<Source>> sources;
+
+    // Command path back to the boards: sendCommand() posts from any thread
+    // and pokes wakeFd; the epoll loop pumps sends and retransmits
+    CommandChannel commands;
+    int wakeFd = -1;
 
     GPS* gps;
     GPSData gpsOffset;
     std::thread gpsThread;
-    
-    // Network communication (will need to be replaced with standard socket implementation)
-    // QTcpServer* ethServer;  // TODO: Replace with standard socket server
-    // QTcpSocket* clientSocket;  // TODO: Replace with standard socket client
-    
+
+    // dead-reckons between 1 Hz fixes using the frame's own speed field,
+    // so position advances at the frame rate instead of the fix rate
+    PositionEstimator estimator;
+    int speedOffset;
+
     // Callback function
     DataFetchedCallback dataFetchedCallback;
 };
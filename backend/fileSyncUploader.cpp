@@ -0,0 +1,171 @@
+#include "fileSyncUploader.h"
+#include "Config.h"
+#include "backend/heartbeat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+FileSyncUploader::FileSyncUploader(std::string directory)
+    : directory(std::move(directory)) {
+    const Config::Settings& settings = Config::getInstance().settings();
+    serverUrl = settings.sqlServerUrl;
+    transferTimeout = settings.sqlTransferTimeout;
+    scanIntervalMs = settings.fileSyncScanIntervalMs;
+}
+
+FileSyncUploader::~FileSyncUploader() {
+    stop();
+}
+
+void FileSyncUploader::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    worker = std::thread(&FileSyncUploader::threadProcedure, this);
+}
+
+void FileSyncUploader::stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    closeConnection();
+}
+
+void FileSyncUploader::threadProcedure() {
+    // liveness for the watchdog: this used to be a fire-and-forget child
+    // process nobody supervised; now the stage beats like any other and the
+    // main loop can see (and kick) a dead or wedged uploader
+    static Heartbeat& heartbeat = PipelineWatchdog::getInstance().stage("filesync");
+    while (running) {
+        // collect candidate segments, oldest first; the names are the open
+        // timestamps, so lexical-by-number order is chronological. The
+        // error_code iterator keeps a vanished directory from throwing out
+        // of this thread and taking the process with it.
+        std::vector<std::string> names;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+            if (entry.is_regular_file()) {
+                names.push_back(entry.path().filename().string());
+            }
+        }
+        std::sort(names.begin(), names.end());
+
+        uint64_t pending = names.empty() ? 0 : names.size() - 1;
+        // skip the newest file: that segment is still being appended to
+        for (size_t i = 0; running && names.size() > 1 && i < names.size() - 1; i++) {
+            std::string path = directory + names[i];
+            if (uploadFile(path, names[i])) {
+                std::filesystem::remove(path);
+                uploaded++;
+                pending--;
+            } else {
+                failed++;
+                break; // server unreachable; retry the whole batch next scan
+            }
+        }
+
+        if (statusCallback) {
+            statusCallback(uploaded, failed, pending);
+        }
+
+        for (int waited = 0; running && waited < scanIntervalMs; waited += 100) {
+            heartbeat.beat(); // liveness, not throughput: beats while idle too
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+bool FileSyncUploader::uploadFile(const std::string& path, const std::string& name) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    std::vector<char> body((size_t)in.tellg());
+    in.seekg(0);
+    in.read(body.data(), (std::streamsize)body.size());
+
+    std::string request = "POST /sync-file?name=" + name + " HTTP/1.1\r\n"
+        "Host: " + serverUrl + "\r\n"
+        "Content-Type: arraybuffer\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "\r\n";
+
+    // two attempts: the server may have dropped the idle connection
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!ensureConnected()) {
+            continue;
+        }
+        if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size() ||
+            ::send(fd, body.data(), body.size(), MSG_NOSIGNAL) != (ssize_t)body.size()) {
+            closeConnection();
+            continue;
+        }
+
+        // the ack is the status line; only delete the file on a 2xx
+        char buf[1024];
+        ssize_t n = ::recv(fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0) {
+            closeConnection();
+            continue;
+        }
+        buf[n] = '\0';
+        const char* space = std::strchr(buf, ' ');
+        if (space != nullptr && space[1] == '2') {
+            // drain whatever is left of the response header
+            return true;
+        }
+        closeConnection();
+        return false;
+    }
+    return false;
+}
+
+bool FileSyncUploader::ensureConnected() {
+    if (fd >= 0) {
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(serverUrl.c_str(), "80", &hints, &res) != 0 || res == nullptr) {
+        return false;
+    }
+
+    fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        fd = -1;
+        return false;
+    }
+
+    timeval tv{transferTimeout / 1000, (transferTimeout % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    bool ok = ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        closeConnection();
+        return false;
+    }
+    return true;
+}
+
+void FileSyncUploader::closeConnection() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
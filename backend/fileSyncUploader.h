@@ -0,0 +1,57 @@
+#ifndef FILESYNCUPLOADER_H
+#define FILESYNCUPLOADER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * In-process replacement for the spawned python file_sync uploader. Watches
+ * the sync directory BackendProcesses writes to, uploads each closed segment
+ * to the cloud server over a persistent HTTP connection, and deletes the
+ * file once the server acknowledges it. The newest file is always skipped -
+ * that is the segment currently being appended to.
+ */
+class FileSyncUploader {
+public:
+    // uploaded/failed are lifetime counters, pending is the current backlog
+    using StatusCallback = std::function<void(uint64_t uploaded, uint64_t failed, uint64_t pending)>;
+
+    explicit FileSyncUploader(std::string directory);
+    ~FileSyncUploader();
+
+    void start();
+    void stop();
+
+    void setStatusCallback(StatusCallback callback) {
+        statusCallback = callback;
+    }
+
+    uint64_t uploadedCount() const { return uploaded; }
+    uint64_t failedCount() const { return failed; }
+
+private:
+    void threadProcedure();
+    // POST one file's contents; true once the server acknowledged it
+    bool uploadFile(const std::string& path, const std::string& name);
+    bool ensureConnected();
+    void closeConnection();
+
+    std::string directory;
+    std::string serverUrl;
+    int transferTimeout;
+    int scanIntervalMs;
+
+    int fd = -1; // persistent connection, reconnected on failure
+
+    std::atomic<bool> running = false;
+    std::atomic<uint64_t> uploaded = 0;
+    std::atomic<uint64_t> failed = 0;
+    std::thread worker;
+    StatusCallback statusCallback;
+};
+
+#endif // FILESYNCUPLOADER_H
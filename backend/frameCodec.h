@@ -0,0 +1,109 @@
+#ifndef FRAMECODEC_H
+#define FRAMECODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <zlib.h>
+
+/**
+ * v2 stream framing, shared by every link that used to wrap frames in
+ * <bsr>...</bsr> tags: a fixed 16-byte header followed by exactly `length`
+ * payload bytes.
+ *
+ *   'B' 'S' 'R' '2'   magic
+ *   uint32 length     payload bytes (little-endian, like everything here)
+ *   uint32 layoutHash DataFormat::layoutHash() of the sender's build
+ *   uint32 crc        zlib crc32 of the payload
+ *
+ * A receiver reads the header and then `length` bytes - O(1) delineation
+ * instead of scanning every payload byte for an end tag (and hoping the
+ * payload never contains one) - and the checksum turns silent corruption
+ * into a counted, skipped record. Senders negotiate per link; legacy peers
+ * keep getting tags, and FramingParser accepts either stream.
+ *
+ * Payloads can optionally travel compressed: the top bit of the length field
+ * flags it, the crc covers the wire (compressed) bytes, and the receiver
+ * inflates before handing the frame out. Frames are mostly runs of unchanged
+ * booleans and zeroed reserved regions, so even the fastest deflate setting
+ * folds them up several-fold. A sender always falls back to raw when
+ * compression would not shrink the payload, so the flag never costs bytes.
+ */
+namespace FrameCodec {
+
+constexpr char MAGIC[4] = {'B', 'S', 'R', '2'};
+constexpr size_t MAGIC_LEN = 4;
+constexpr size_t HEADER_BYTES = 16;
+
+// negotiation token a receiver sends to request compressed v2 records
+// (plain "BSR2" requests uncompressed v2)
+constexpr char TOKEN_COMPRESSED[4] = {'B', 'S', 'R', 'Z'};
+
+constexpr uint32_t LENGTH_MASK = 0x7FFFFFFFu;
+constexpr uint32_t COMPRESSED_FLAG = 0x80000000u;
+
+struct Header {
+    uint32_t length;  // payload bytes on the wire
+    uint32_t layoutHash;
+    uint32_t crc;
+    bool compressed;  // payload is deflated; inflate to get the frame
+};
+
+// zlib's crc32 rather than CRC32C: it is already linked for the black box,
+// and nothing guarantees SSE4.2 on the target SBC
+inline uint32_t checksum(const uint8_t* data, size_t len) {
+    return (uint32_t)::crc32(0, data, (uInt)len);
+}
+
+inline void writeHeader(uint8_t* out, uint32_t length, uint32_t layoutHash, uint32_t crc,
+                        bool compressed = false) {
+    uint32_t lengthField = length | (compressed ? COMPRESSED_FLAG : 0);
+    std::memcpy(out, MAGIC, MAGIC_LEN);
+    std::memcpy(out + 4, &lengthField, sizeof(lengthField));
+    std::memcpy(out + 8, &layoutHash, sizeof(layoutHash));
+    std::memcpy(out + 12, &crc, sizeof(crc));
+}
+
+// `in` must hold HEADER_BYTES; false if the magic doesn't match
+inline bool readHeader(const uint8_t* in, Header& out) {
+    if (std::memcmp(in, MAGIC, MAGIC_LEN) != 0) {
+        return false;
+    }
+    uint32_t lengthField;
+    std::memcpy(&lengthField, in + 4, sizeof(lengthField));
+    out.length = lengthField & LENGTH_MASK;
+    out.compressed = (lengthField & COMPRESSED_FLAG) != 0;
+    std::memcpy(&out.layoutHash, in + 8, sizeof(out.layoutHash));
+    std::memcpy(&out.crc, in + 12, sizeof(out.crc));
+    return true;
+}
+
+// Deflate `len` bytes of `src` into `out` (resized as needed). Returns the
+// compressed size, or 0 when compression would not shrink the payload - the
+// caller sends raw in that case. Level 1: the send worker's cycles are the
+// scarce resource, and run-heavy frames compress almost as well at 1 as at 9.
+inline size_t compressPayload(const uint8_t* src, size_t len, std::vector<uint8_t>& out) {
+    if (out.size() < ::compressBound((uLong)len)) {
+        out.resize(::compressBound((uLong)len));
+    }
+    uLongf outLen = (uLongf)out.size();
+    if (::compress2(out.data(), &outLen, src, (uLong)len, 1) != Z_OK || outLen >= len) {
+        return 0;
+    }
+    return (size_t)outLen;
+}
+
+// Inflate a compressed payload into `dst`; returns the frame size, or 0 on
+// corrupt input (counted by the caller like a checksum failure)
+inline size_t decompressPayload(const uint8_t* src, size_t len, uint8_t* dst, size_t dstCap) {
+    uLongf outLen = (uLongf)dstCap;
+    if (::uncompress(dst, &outLen, src, (uLong)len) != Z_OK) {
+        return 0;
+    }
+    return (size_t)outLen;
+}
+
+} // namespace FrameCodec
+
+#endif // FRAMECODEC_H
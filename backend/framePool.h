@@ -0,0 +1,142 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "backend/telemetrylib/frame.h"
+
+/**
+ * Fixed-size pool of frame buffers shared across the pipeline.
+ *
+ * A slab of frame-capacity vectors is preallocated up front and recycled
+ * through two lock-free Treiber stacks (buffers ready to hand out, and empty
+ * nodes awaiting a returned buffer), so steady-state frame traffic touches
+ * the heap allocator zero times: BackendProcesses draws a buffer per cycle,
+ * the sinks drop their FramePtr references, and the last reference returns
+ * the buffer here from whichever channel thread it dies on. Stack heads
+ * carry a generation tag against ABA. If demand ever exceeds the slab the
+ * pool falls back to plain allocation and counts the miss; highWater() says
+ * how close a race day actually came to the cap.
+ */
+class FramePool {
+public:
+    FramePool(size_t frameBytes, uint32_t capacity = 64)
+        : frameBytes(frameBytes), nodes(capacity) {
+        // seed every node with a full-capacity buffer on the ready stack
+        for (uint32_t i = 0; i < capacity; i++) {
+            nodes[i].buf.reserve(frameBytes);
+            nodes[i].next = i + 1 < capacity ? i + 1 : NIL;
+        }
+        ready.store(pack(capacity > 0 ? 0 : NIL, 0), std::memory_order_relaxed);
+        empty.store(pack(NIL, 0), std::memory_order_relaxed);
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // Build a pooled frame holding a copy of src. The returned FramePtr's
+    // deleter recycles the buffer, so the pool must outlive every frame.
+    FramePtr makeFrame(const std::vector<uint8_t>& src, long long timestamp) {
+        std::vector<uint8_t> buf = acquire();
+        buf.assign(src.begin(), src.end()); // capacity reserved: no allocation
+        uint32_t used = ++inUseCount;
+        uint32_t high = highWaterMark.load(std::memory_order_relaxed);
+        while (used > high && !highWaterMark.compare_exchange_weak(high, used)) {
+        }
+        return FramePtr(new Frame(std::move(buf), timestamp),
+                        [this](const Frame* f) { recycle(f); });
+    }
+
+    // Dirty-touch every slab buffer so race mode's first frames never take
+    // a page fault; capacity stays reserved and sizes stay zero. Only safe
+    // before the pipeline starts drawing frames.
+    void prefault() {
+        for (Node& n : nodes) {
+            n.buf.assign(frameBytes, 0);
+            n.buf.clear();
+        }
+    }
+
+    // Stats for the periodic dump
+    uint32_t inUse() const { return inUseCount.load(std::memory_order_relaxed); }
+    uint32_t highWater() const { return highWaterMark.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Node {
+        std::vector<uint8_t> buf;
+        uint32_t next = NIL;
+    };
+
+    static uint64_t pack(uint32_t idx, uint32_t tag) {
+        return ((uint64_t)tag << 32) | idx;
+    }
+    static uint32_t idxOf(uint64_t head) { return (uint32_t)head; }
+    static uint32_t tagOf(uint64_t head) { return (uint32_t)(head >> 32); }
+
+    // Pop a node index off a stack; NIL when empty
+    uint32_t pop(std::atomic<uint64_t>& stack) {
+        uint64_t head = stack.load(std::memory_order_acquire);
+        while (idxOf(head) != NIL) {
+            uint64_t next = pack(nodes[idxOf(head)].next, tagOf(head) + 1);
+            if (stack.compare_exchange_weak(head, next, std::memory_order_acq_rel)) {
+                return idxOf(head);
+            }
+        }
+        return NIL;
+    }
+
+    void push(std::atomic<uint64_t>& stack, uint32_t idx) {
+        uint64_t head = stack.load(std::memory_order_acquire);
+        do {
+            nodes[idx].next = idxOf(head);
+        } while (!stack.compare_exchange_weak(head, pack(idx, tagOf(head) + 1),
+                                              std::memory_order_acq_rel));
+    }
+
+    std::vector<uint8_t> acquire() {
+        uint32_t idx = pop(ready);
+        if (idx == NIL) {
+            // slab exhausted: fall back to the allocator rather than block
+            missCount.fetch_add(1, std::memory_order_relaxed);
+            std::vector<uint8_t> buf;
+            buf.reserve(frameBytes);
+            return buf;
+        }
+        std::vector<uint8_t> buf = std::move(nodes[idx].buf);
+        push(empty, idx);
+        return buf;
+    }
+
+    void recycle(const Frame* f) {
+        // Frame is only reachable as const through FramePtr; the pool made
+        // it, so it may take the buffer back
+        std::vector<uint8_t> buf = std::move(const_cast<Frame*>(f)->data);
+        delete f;
+        inUseCount--;
+        if (buf.capacity() >= frameBytes) {
+            uint32_t idx = pop(empty);
+            if (idx != NIL) {
+                buf.clear();
+                nodes[idx].buf = std::move(buf);
+                push(ready, idx);
+                return;
+            }
+        }
+        // overflow buffer (a miss on the way out); let the allocator have it
+    }
+
+    size_t frameBytes;
+    std::vector<Node> nodes;
+    std::atomic<uint64_t> ready{0}; // nodes holding a buffer to hand out
+    std::atomic<uint64_t> empty{0}; // nodes waiting for a returned buffer
+    std::atomic<uint32_t> inUseCount{0};
+    std::atomic<uint32_t> highWaterMark{0};
+    std::atomic<uint64_t> missCount{0};
+};
+
+#endif // FRAMEPOOL_H
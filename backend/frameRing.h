@@ -0,0 +1,88 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Fixed-capacity single-producer/single-consumer ring of preallocated frame
+ * slots carrying frames from the fetch thread to the backend thread. The
+ * producer never blocks: when the ring is full it reclaims the oldest
+ * unconsumed slot and counts the drop, so a stalled consumer costs the oldest
+ * data, not the newest, and every lost frame is accounted for.
+ *
+ * The consumer can drain everything that is queued in one wakeup, which turns
+ * the pipeline into real batching instead of one wakeup per frame.
+ */
+class FrameRing {
+public:
+    FrameRing(int frameSize, size_t capacity)
+        : frameSize(frameSize), capacity(capacity), slots(capacity * frameSize, 0),
+          tags(capacity, 0) {}
+
+    // Producer side: enqueue a frame, reclaiming the oldest slot if full.
+    // tag rides along with the frame (we use it for the ingress timestamp).
+    void push(const uint8_t* data, size_t len, uint64_t tag = 0) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        uint64_t h = head.load(std::memory_order_acquire);
+        if (t - h == capacity) {
+            // Ring full: advance head past the oldest frame ourselves. The
+            // consumer CASes head too, so only one of us wins the slot.
+            if (head.compare_exchange_strong(h, h + 1, std::memory_order_acq_rel)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        uint8_t* slot = slots.data() + (t % capacity) * frameSize;
+        memcpy(slot, data, len < (size_t)frameSize ? len : (size_t)frameSize);
+        tags[t % capacity] = tag;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    // Consumer side: copy the oldest frame into out. Returns false when empty.
+    bool pop(std::vector<uint8_t>& out, uint64_t* tag = nullptr) {
+        while (true) {
+            uint64_t h = head.load(std::memory_order_acquire);
+            uint64_t t = tail.load(std::memory_order_acquire);
+            if (h == t) {
+                return false;
+            }
+            const uint8_t* slot = slots.data() + (h % capacity) * frameSize;
+            out.assign(slot, slot + frameSize);
+            uint64_t slotTag = tags[h % capacity];
+            // Revalidate: if the producer lapped us mid-copy the slot may have
+            // been reused; if it stole head the frame was dropped. Retry both.
+            if (tail.load(std::memory_order_acquire) - h > capacity) {
+                continue;
+            }
+            if (head.compare_exchange_strong(h, h + 1, std::memory_order_acq_rel)) {
+                if (tag != nullptr) {
+                    *tag = slotTag;
+                }
+                return true;
+            }
+        }
+    }
+
+    // Frames currently queued (approximate when both threads are running).
+    size_t size() const {
+        uint64_t h = head.load(std::memory_order_acquire);
+        uint64_t t = tail.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+
+    // Total frames overwritten before the consumer got to them.
+    uint64_t droppedOldest() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    const int frameSize;
+    const size_t capacity;
+    std::vector<uint8_t> slots;
+    std::vector<uint64_t> tags;
+    std::atomic<uint64_t> head{0}; // next slot to consume
+    std::atomic<uint64_t> tail{0}; // next slot to fill
+    std::atomic<uint64_t> dropped{0};
+};
+
+#endif // FRAMERING_H
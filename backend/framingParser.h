@@ -0,0 +1,373 @@
+#ifndef FRAMINGPARSER_H
+#define FRAMINGPARSER_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "backend/frameCodec.h"
+
+/**
+ * Incremental stream parser for both frame framings.
+ *
+ * The first bytes of a connection pick the mode: a v2 sender leads with the
+ * FrameCodec record magic and gets header-driven parsing - read a 16-byte
+ * header, then exactly `length` payload bytes, then verify the checksum -
+ * while anything else falls back to the legacy <bsr>payload</bsr> tag
+ * machine, so old boards and the python sim keep working unchanged.
+ *
+ * Socket bytes are consumed exactly once in either mode: tag matching and
+ * header/payload fills keep their progress between reads, so nothing is ever
+ * rescanned. Payload bytes are written straight into a fixed internal buffer
+ * and complete frames are handed out as a pointer+length view into that
+ * buffer - no further copies until the caller decides what to do with the
+ * frame.
+ */
+class FramingParser {
+public:
+    // expectedLayoutHash != 0 makes v2 records from a different frame layout
+    // count as mismatches instead of being handed out; the legacy path has no
+    // per-record hash, so there the caller's connection-level check stands.
+    explicit FramingParser(size_t expectedFrameSize, uint32_t expectedLayoutHash = 0)
+        : expectedSize(expectedFrameSize), expectedHash(expectedLayoutHash),
+          payload(expectedFrameSize) {}
+
+    /**
+     * Feed a chunk from the socket. onFrame(uint8_t* data, size_t len) is
+     * invoked for every completed frame; the view is valid until the next
+     * consume() call. Frames longer than the expected size are discarded and
+     * counted instead of buffered.
+     */
+    template <typename OnFrame>
+    void consume(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+        size_t i = 0;
+        // first bytes decide the framing for the rest of the connection
+        while (mode == Mode::Detect && i < len) {
+            const uint8_t b = data[i++];
+            detectBuf[detectLen++] = b;
+            if (b != (uint8_t)FrameCodec::MAGIC[detectLen - 1]) {
+                mode = Mode::Legacy;
+                consumeLegacy(detectBuf, detectLen, onFrame);
+                break;
+            }
+            if (detectLen == FrameCodec::MAGIC_LEN) {
+                // magic already consumed; the header fill continues after it
+                mode = Mode::V2;
+                v2State = V2State::Header;
+                std::memcpy(headerBuf, detectBuf, detectLen);
+                headerLen = detectLen;
+                break;
+            }
+        }
+        if (mode == Mode::Legacy) {
+            consumeLegacy(data + i, len - i, onFrame);
+        } else if (mode == Mode::V2) {
+            consumeV2(data + i, len - i, onFrame);
+        }
+    }
+
+    // Complete frames handed out so far.
+    uint64_t framesParsed() const { return frames; }
+
+    // Frames discarded because they outgrew the expected frame size.
+    uint64_t oversizedDropped() const { return oversized; }
+
+    // v2 records dropped for a failed payload checksum / wrong layout hash /
+    // a compressed payload that would not inflate.
+    uint64_t crcFailures() const { return crcFailed; }
+    uint64_t layoutMismatches() const { return hashMismatched; }
+    uint64_t decompressFailures() const { return inflateFailed; }
+
+    // Corruption visibility: times the scanner had to skip garbage to find
+    // the next start tag (or record magic), total bytes thrown away doing so,
+    // and the largest single gap (a connector vibration burst shows up here).
+    uint64_t resyncCount() const { return resyncs; }
+    uint64_t bytesDiscarded() const { return discarded; }
+    uint64_t largestGapBytes() const { return largestGap; }
+
+private:
+    enum class Mode { Detect, Legacy, V2 };
+    enum class State { SeekStart, InFrame };
+    enum class V2State { SeekMagic, Header, Payload };
+
+    template <typename OnFrame>
+    void consumeLegacy(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+        size_t i = 0;
+        while (i < len) {
+            if (state == State::SeekStart) {
+                if (startMatched == 0) {
+                    // Bulk resync: locate the next start tag in one memmem
+                    // pass instead of walking garbage a byte at a time, so a
+                    // corrupt span costs O(span) once. Whatever precedes the
+                    // tag is the gap.
+                    const void* hit = memmem(data + i, len - i, START_TAG, START_TAG_LEN);
+                    if (hit != nullptr) {
+                        size_t pos = (size_t)((const uint8_t*)hit - data);
+                        gapCurrent += pos - i;
+                        i = pos + START_TAG_LEN;
+                        beginFrame();
+                    } else {
+                        // no full tag in this chunk; keep a tag prefix at the
+                        // tail alive for the next read, discard the rest
+                        size_t keep = tagPrefixAtTail(data + i, len - i);
+                        gapCurrent += (len - i) - keep;
+                        startMatched = keep;
+                        i = len;
+                    }
+                    continue;
+                }
+                // a tag split across reads: finish or refute it byte-wise
+                if (data[i] == START_TAG[startMatched]) {
+                    i++;
+                    if (++startMatched == START_TAG_LEN) {
+                        beginFrame();
+                    }
+                } else {
+                    // the matched prefix was garbage after all
+                    gapCurrent += startMatched;
+                    startMatched = 0;
+                }
+                continue;
+            }
+
+            const uint8_t b = data[i++];
+
+            // State::InFrame: match the end tag incrementally; bytes that
+            // break a partial match belong to the payload.
+            if (b == END_TAG[endMatched]) {
+                if (++endMatched == END_TAG_LEN) {
+                    if (!oversize) {
+                        frames++;
+                        onFrame(payload.data(), payloadLen);
+                    } else {
+                        oversized++;
+                    }
+                    state = State::SeekStart;
+                }
+                continue;
+            }
+
+            // flush the partially matched end tag prefix into the payload
+            for (size_t j = 0; j < endMatched; j++) {
+                appendPayload(END_TAG[j]);
+            }
+            // the current byte may itself start a new end tag match
+            if (b == END_TAG[0]) {
+                endMatched = 1;
+            } else {
+                endMatched = 0;
+                appendPayload(b);
+            }
+        }
+    }
+
+    template <typename OnFrame>
+    void consumeV2(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+        size_t i = 0;
+        while (i < len) {
+            if (v2State == V2State::SeekMagic) {
+                if (magicMatched == 0) {
+                    // bulk resync, same idea as the legacy tag scan
+                    const void* hit = memmem(data + i, len - i,
+                                             FrameCodec::MAGIC, FrameCodec::MAGIC_LEN);
+                    if (hit != nullptr) {
+                        size_t pos = (size_t)((const uint8_t*)hit - data);
+                        gapCurrent += pos - i;
+                        i = pos + FrameCodec::MAGIC_LEN;
+                        bookGap();
+                        std::memcpy(headerBuf, FrameCodec::MAGIC, FrameCodec::MAGIC_LEN);
+                        headerLen = FrameCodec::MAGIC_LEN;
+                        v2State = V2State::Header;
+                    } else {
+                        size_t keep = magicPrefixAtTail(data + i, len - i);
+                        gapCurrent += (len - i) - keep;
+                        magicMatched = keep;
+                        i = len;
+                    }
+                    continue;
+                }
+                if (data[i] == (uint8_t)FrameCodec::MAGIC[magicMatched]) {
+                    i++;
+                    if (++magicMatched == FrameCodec::MAGIC_LEN) {
+                        magicMatched = 0;
+                        bookGap();
+                        std::memcpy(headerBuf, FrameCodec::MAGIC, FrameCodec::MAGIC_LEN);
+                        headerLen = FrameCodec::MAGIC_LEN;
+                        v2State = V2State::Header;
+                    }
+                } else {
+                    gapCurrent += magicMatched;
+                    magicMatched = 0;
+                }
+                continue;
+            }
+
+            if (v2State == V2State::Header) {
+                size_t take = FrameCodec::HEADER_BYTES - headerLen;
+                if (take > len - i) {
+                    take = len - i;
+                }
+                std::memcpy(headerBuf + headerLen, data + i, take);
+                headerLen += take;
+                i += take;
+                if (headerLen < FrameCodec::HEADER_BYTES) {
+                    continue; // rest of the header is in the next read
+                }
+                if (!FrameCodec::readHeader(headerBuf, header) ||
+                    header.length == 0 || header.length > expectedSize) {
+                    // garbage where a header should be. The 16 bytes may
+                    // straddle the junk and the start of a real record, so
+                    // rescan them before throwing them all away.
+                    const void* hit = memmem(headerBuf + 1, FrameCodec::HEADER_BYTES - 1,
+                                             FrameCodec::MAGIC, FrameCodec::MAGIC_LEN);
+                    if (hit != nullptr) {
+                        size_t pos = (size_t)((const uint8_t*)hit - headerBuf);
+                        gapCurrent += pos;
+                        bookGap();
+                        std::memmove(headerBuf, headerBuf + pos,
+                                     FrameCodec::HEADER_BYTES - pos);
+                        headerLen = FrameCodec::HEADER_BYTES - pos;
+                        continue; // keep filling the shifted header
+                    }
+                    size_t keep = magicPrefixAtTail(headerBuf, FrameCodec::HEADER_BYTES);
+                    gapCurrent += FrameCodec::HEADER_BYTES - keep;
+                    magicMatched = keep;
+                    headerLen = 0;
+                    v2State = V2State::SeekMagic;
+                    continue;
+                }
+                payloadLen = 0;
+                v2State = V2State::Payload;
+                continue;
+            }
+
+            // V2State::Payload: exactly header.length bytes, bulk-copied -
+            // no per-byte scanning, the header already told us where the
+            // record ends
+            size_t take = header.length - payloadLen;
+            if (take > len - i) {
+                take = len - i;
+            }
+            std::memcpy(payload.data() + payloadLen, data + i, take);
+            payloadLen += take;
+            i += take;
+            if (payloadLen < header.length) {
+                continue;
+            }
+            if (FrameCodec::checksum(payload.data(), payloadLen) != header.crc) {
+                crcFailed++; // corrupt record, counted and skipped
+            } else if (expectedHash != 0 && header.layoutHash != expectedHash) {
+                hashMismatched++;
+            } else if (header.compressed) {
+                // compressed record: inflate into a second buffer so the
+                // wire bytes stay put; allocated on first use, as a
+                // connection either always or never compresses
+                if (inflated.size() < expectedSize) {
+                    inflated.resize(expectedSize);
+                }
+                size_t n = FrameCodec::decompressPayload(payload.data(), payloadLen,
+                                                         inflated.data(), inflated.size());
+                if (n == 0) {
+                    inflateFailed++;
+                } else {
+                    frames++;
+                    onFrame(inflated.data(), n);
+                }
+            } else {
+                frames++;
+                onFrame(payload.data(), payloadLen);
+            }
+            headerLen = 0;
+            v2State = V2State::Header;
+        }
+    }
+
+    // A start tag was found; book the gap that preceded it and reset the
+    // frame state
+    void beginFrame() {
+        bookGap();
+        startMatched = 0;
+        payloadLen = 0;
+        endMatched = 0;
+        oversize = false;
+        state = State::InFrame;
+    }
+
+    void bookGap() {
+        if (gapCurrent > 0) {
+            resyncs++;
+            discarded += gapCurrent;
+            largestGap = gapCurrent > largestGap ? gapCurrent : largestGap;
+            gapCurrent = 0;
+        }
+    }
+
+    // Longest suffix of buf that is a proper prefix of the start tag
+    static size_t tagPrefixAtTail(const uint8_t* buf, size_t n) {
+        size_t maxKeep = n < START_TAG_LEN - 1 ? n : START_TAG_LEN - 1;
+        for (size_t k = maxKeep; k > 0; k--) {
+            if (memcmp(buf + n - k, START_TAG, k) == 0) {
+                return k;
+            }
+        }
+        return 0;
+    }
+
+    static size_t magicPrefixAtTail(const uint8_t* buf, size_t n) {
+        size_t maxKeep = n < FrameCodec::MAGIC_LEN - 1 ? n : FrameCodec::MAGIC_LEN - 1;
+        for (size_t k = maxKeep; k > 0; k--) {
+            if (memcmp(buf + n - k, FrameCodec::MAGIC, k) == 0) {
+                return k;
+            }
+        }
+        return 0;
+    }
+
+    void appendPayload(uint8_t b) {
+        if (payloadLen < expectedSize) {
+            payload[payloadLen++] = b;
+        } else {
+            oversize = true; // corrupt/overlong frame, discard at the end tag
+        }
+    }
+
+    static constexpr char START_TAG[] = "<bsr>";
+    static constexpr size_t START_TAG_LEN = 5;
+    static constexpr char END_TAG[] = "</bsr>";
+    static constexpr size_t END_TAG_LEN = 6;
+
+    const size_t expectedSize;
+    const uint32_t expectedHash;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> inflated; // decompressed-record buffer, lazily sized
+    size_t payloadLen = 0;
+
+    Mode mode = Mode::Detect;
+    uint8_t detectBuf[FrameCodec::MAGIC_LEN];
+    size_t detectLen = 0;
+
+    // legacy tag machine
+    State state = State::SeekStart;
+    size_t startMatched = 0;
+    size_t endMatched = 0;
+    bool oversize = false;
+
+    // v2 header machine
+    V2State v2State = V2State::Header;
+    uint8_t headerBuf[FrameCodec::HEADER_BYTES];
+    size_t headerLen = 0;
+    size_t magicMatched = 0;
+    FrameCodec::Header header{};
+
+    uint64_t frames = 0;
+    uint64_t oversized = 0;
+    uint64_t crcFailed = 0;
+    uint64_t hashMismatched = 0;
+    uint64_t inflateFailed = 0;
+    uint64_t gapCurrent = 0;  // garbage bytes in the current seek
+    uint64_t resyncs = 0;
+    uint64_t discarded = 0;
+    uint64_t largestGap = 0;
+};
+
+#endif // FRAMINGPARSER_H
@@ -0,0 +1,185 @@
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Per-stage heartbeat counters plus the supervisor that watches them.
+ *
+ * Each pipeline stage (fetch, backend, gps, one per sink) bumps a relaxed
+ * atomic once per unit of progress - same cost model as the latency
+ * histograms, cheap enough to stay on in races. The main loop calls
+ * poll(), which turns the counters into rates, logs a periodic status
+ * line, and flags any stage that was moving but has stopped while it
+ * should still be. A stage can register a restart hook; a stage stalled
+ * long enough gets kicked instead of silently costing telemetry until
+ * someone notices the dashboard froze.
+ */
+class Heartbeat {
+public:
+    void beat() { count.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+class PipelineWatchdog {
+public:
+    static PipelineWatchdog& getInstance() {
+        static PipelineWatchdog instance;
+        return instance;
+    }
+
+    static int64_t nowMs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    /**
+     * Counter for a named stage. Cold path only: resolve once at setup and
+     * keep the reference, like LatencyStats::stage().
+     */
+    Heartbeat& stage(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        return *findStage(name).beat;
+    }
+
+    // Hook invoked (from the main thread) when the stage has been stalled
+    // past the restart threshold
+    void setRestart(const std::string& name, std::function<void()> fn) {
+        std::lock_guard<std::mutex> lock(m);
+        findStage(name).restart = std::move(fn);
+    }
+
+    // Stage progress counters for the metrics endpoint; the beats are the
+    // same numbers poll() turns into the rate lines
+    void exportMetrics(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(m);
+        if (!stages.empty()) {
+            out << "# TYPE pipeline_beats_total counter\n";
+        }
+        for (auto& s : stages) {
+            out << "pipeline_beats_total{stage=\"" << s.name << "\"} "
+                << s.beat->value() << "\n";
+        }
+    }
+
+    /**
+     * Called from the main loop at whatever cadence it runs; paces itself
+     * internally. Detection, logging and restarts all happen here, so the
+     * hot paths never do more than the one atomic increment.
+     */
+    void poll(std::ostream& out) {
+        int64_t now = nowMs();
+        if (now - lastPollMs < POLL_INTERVAL_MS) {
+            return;
+        }
+        int64_t sinceStatus = now - lastStatusMs;
+        bool status = sinceStatus >= STATUS_INTERVAL_MS;
+
+        std::vector<std::function<void()>> restarts;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            std::string statusLine;
+            for (auto& s : stages) {
+                uint64_t count = s.beat->value();
+                if (count != s.lastCount) {
+                    s.lastCount = count;
+                    s.lastProgressMs = now;
+                    s.active = true;
+                    if (s.stallLogged) {
+                        out << "watchdog: " << s.name << " is moving again" << std::endl;
+                        s.stallLogged = false;
+                    }
+                } else if (s.active && now - s.lastProgressMs >= STALL_MS) {
+                    if (!s.stallLogged) {
+                        out << "watchdog: " << s.name << " stalled, no progress for "
+                            << (now - s.lastProgressMs) / 1000 << "s" << std::endl;
+                        s.stallLogged = true;
+                    }
+                    if (s.restart && now - s.lastProgressMs >= RESTART_MS) {
+                        out << "watchdog: restarting " << s.name << std::endl;
+                        restarts.push_back(s.restart);
+                        // treat the kick as progress so a stage that stays
+                        // dead is re-kicked one RESTART_MS later, not every poll
+                        s.lastProgressMs = now;
+                    }
+                }
+                if (status) {
+                    double rate = (double)(count - s.statusCount) * 1000.0 / (double)sinceStatus;
+                    char buf[64];
+                    snprintf(buf, sizeof(buf), "%s%s %.1f/s", statusLine.empty() ? "" : ", ",
+                             s.name.c_str(), rate);
+                    statusLine += buf;
+                    s.statusCount = count;
+                }
+            }
+            if (status && !statusLine.empty()) {
+                out << "watchdog: " << statusLine << std::endl;
+            }
+        }
+        if (status) {
+            lastStatusMs = now;
+        }
+        lastPollMs = now;
+
+        // run restart hooks outside the lock; they may join threads that
+        // are about to bump a counter
+        for (auto& fn : restarts) {
+            fn();
+        }
+    }
+
+private:
+    // check cadence / stall threshold / give-a-kick threshold
+    static constexpr int64_t POLL_INTERVAL_MS = 1000;
+    static constexpr int64_t STATUS_INTERVAL_MS = 10000;
+    static constexpr int64_t STALL_MS = 5000;
+    static constexpr int64_t RESTART_MS = 30000;
+
+    struct Stage {
+        std::string name;
+        std::unique_ptr<Heartbeat> beat;
+        std::function<void()> restart;
+        uint64_t lastCount = 0;   // value at the last poll
+        uint64_t statusCount = 0; // value at the last status line
+        int64_t lastProgressMs = 0;
+        bool active = false;      // has ever made progress
+        bool stallLogged = false;
+    };
+
+    Stage& findStage(const std::string& name) {
+        for (auto& s : stages) {
+            if (s.name == name) {
+                return s;
+            }
+        }
+        stages.emplace_back();
+        stages.back().name = name;
+        stages.back().beat = std::make_unique<Heartbeat>();
+        stages.back().lastProgressMs = nowMs();
+        return stages.back();
+    }
+
+    PipelineWatchdog() = default;
+    PipelineWatchdog(const PipelineWatchdog&) = delete;
+    void operator=(const PipelineWatchdog&) = delete;
+
+    std::mutex m;
+    std::vector<Stage> stages;
+    int64_t lastPollMs = 0;
+    int64_t lastStatusMs = 0;
+};
+
+#endif // HEARTBEAT_H
@@ -0,0 +1,141 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Lock-free per-stage latency histograms, cheap enough to leave enabled in
+ * races. record() is a monotonic clock read (vDSO, no syscall), one relaxed
+ * atomic increment into a log2 bucket and a relaxed max update - no locks, no
+ * allocation. Stage histograms are resolved to a pointer once on the cold
+ * path (stage()) and recorded into directly on the hot path.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 64; // bucket i covers [2^i, 2^(i+1)) ns
+
+    void record(uint64_t ns) {
+        int b = 0;
+        while (ns >> (b + 1) && b < BUCKETS - 1) {
+            b++;
+        }
+        buckets[b].fetch_add(1, std::memory_order_relaxed);
+        uint64_t prev = maxNs.load(std::memory_order_relaxed);
+        while (ns > prev && !maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t samples() const {
+        uint64_t n = 0;
+        for (const auto& b : buckets) {
+            n += b.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    // Upper bound of the bucket holding the p-th percentile sample (p in 0..1)
+    uint64_t percentile(double p) const {
+        uint64_t total = samples();
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(p * (double)total);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                return (uint64_t)2 << i;
+            }
+        }
+        return maxNs.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> maxNs{0};
+};
+
+class LatencyStats {
+public:
+    static LatencyStats& getInstance() {
+        static LatencyStats instance;
+        return instance;
+    }
+
+    // Monotonic nanoseconds; clock_gettime(CLOCK_MONOTONIC) is vDSO on Linux
+    static uint64_t nowNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    }
+
+    /**
+     * Histogram for a named stage. Cold path only: call once at setup and
+     * keep the reference; the histogram lives for the process lifetime.
+     */
+    LatencyHistogram& stage(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        for (auto& s : stages) {
+            if (s.first == name) {
+                return *s.second;
+            }
+        }
+        stages.emplace_back(name, std::make_unique<LatencyHistogram>());
+        return *stages.back().second;
+    }
+
+    // Prometheus-style quantile gauges for the metrics endpoint: exact
+    // histogram buckets stay internal, the scraper gets p50/p99/max per stage
+    void exportMetrics(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(m);
+        if (!stages.empty()) {
+            out << "# TYPE pipeline_latency_ns gauge\n";
+        }
+        for (auto& s : stages) {
+            if (s.second->samples() == 0) {
+                continue;
+            }
+            out << "pipeline_latency_ns{stage=\"" << s.first << "\",q=\"0.5\"} "
+                << s.second->percentile(0.50) << "\n"
+                << "pipeline_latency_ns{stage=\"" << s.first << "\",q=\"0.99\"} "
+                << s.second->percentile(0.99) << "\n"
+                << "pipeline_latency_ns{stage=\"" << s.first << "\",q=\"max\"} "
+                << s.second->max() << "\n";
+        }
+    }
+
+    // One line per stage: samples, p50/p99/max in microseconds
+    void dump(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(m);
+        for (auto& s : stages) {
+            uint64_t n = s.second->samples();
+            if (n == 0) {
+                continue;
+            }
+            out << "latency " << s.first << ": n=" << n
+                << " p50=" << s.second->percentile(0.50) / 1000 << "us"
+                << " p99=" << s.second->percentile(0.99) / 1000 << "us"
+                << " max=" << s.second->max() / 1000 << "us" << std::endl;
+        }
+    }
+
+private:
+    LatencyStats() = default;
+    LatencyStats(const LatencyStats&) = delete;
+    void operator=(const LatencyStats&) = delete;
+
+    std::mutex m;
+    std::vector<std::pair<std::string, std::unique_ptr<LatencyHistogram>>> stages;
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,129 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Process-wide metrics registry, same cost model as the latency histograms
+ * and heartbeats: the hot path pays one relaxed atomic per event, and all
+ * naming, registration and text rendering happen on the cold path or on the
+ * scraper's thread.
+ *
+ * Three metric shapes cover the pipeline:
+ *  - Counter: monotonic event count (frames ingested, sentences parsed)
+ *  - Gauge:   last-written value (connected sources, fix validity)
+ *  - sampler: value computed at scrape time (queue depths, ring drop
+ *    totals) - the owning component registers a closure and its hot path
+ *    pays nothing at all
+ *
+ * render() emits the Prometheus text format, one "# TYPE" line plus a value
+ * line per metric; label syntax in a registered name passes through as-is.
+ */
+class Counter {
+public:
+    void add(uint64_t n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { val.store(v, std::memory_order_relaxed); }
+    int64_t value() const { return val.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> val{0};
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+
+    /**
+     * Counter/gauge for a name. Cold path only: resolve once at setup and
+     * keep the reference, like LatencyStats::stage(); the metric lives for
+     * the process lifetime.
+     */
+    Counter& counter(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        for (auto& c : counters) {
+            if (c.first == name) {
+                return *c.second;
+            }
+        }
+        counters.emplace_back(name, std::make_unique<Counter>());
+        return *counters.back().second;
+    }
+
+    Gauge& gauge(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        for (auto& g : gauges) {
+            if (g.first == name) {
+                return *g.second;
+            }
+        }
+        gauges.emplace_back(name, std::make_unique<Gauge>());
+        return *gauges.back().second;
+    }
+
+    // Value pulled at scrape time; counterStyle picks the advertised type.
+    // The closure runs on the scraper thread, so it may take a short lock.
+    void sampler(const std::string& name, bool counterStyle, std::function<int64_t()> fn) {
+        std::lock_guard<std::mutex> lock(m);
+        samplers.push_back({name, counterStyle, std::move(fn)});
+    }
+
+    // Prometheus text format; called from the scraper thread only
+    void render(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(m);
+        for (auto& c : counters) {
+            out << "# TYPE " << baseName(c.first) << " counter\n"
+                << c.first << " " << c.second->value() << "\n";
+        }
+        for (auto& g : gauges) {
+            out << "# TYPE " << baseName(g.first) << " gauge\n"
+                << g.first << " " << g.second->value() << "\n";
+        }
+        for (auto& s : samplers) {
+            out << "# TYPE " << baseName(s.name) << " "
+                << (s.counterStyle ? "counter" : "gauge") << "\n"
+                << s.name << " " << s.fn() << "\n";
+        }
+    }
+
+private:
+    struct Sampler {
+        std::string name;
+        bool counterStyle;
+        std::function<int64_t()> fn;
+    };
+
+    // metric name without any {label} suffix, for the "# TYPE" line
+    static std::string baseName(const std::string& name) {
+        size_t brace = name.find('{');
+        return brace == std::string::npos ? name : name.substr(0, brace);
+    }
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    void operator=(const MetricsRegistry&) = delete;
+
+    std::mutex m;
+    std::vector<std::pair<std::string, std::unique_ptr<Counter>>> counters;
+    std::vector<std::pair<std::string, std::unique_ptr<Gauge>>> gauges;
+    std::vector<Sampler> samplers;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,125 @@
+#include "metricsServer.h"
+#include "backend/heartbeat.h"
+#include "backend/latencyStats.h"
+#include "backend/metrics.h"
+#include "backend/timebase.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+MetricsServer::MetricsServer(int port, std::string dumpDirectory)
+    : port(port), dumpDirectory(std::move(dumpDirectory)) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    worker = std::thread(&MetricsServer::threadProcedure, this);
+}
+
+void MetricsServer::stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+}
+
+std::string MetricsServer::renderAll() {
+    std::ostringstream body;
+    MetricsRegistry::getInstance().render(body);
+    PipelineWatchdog::getInstance().exportMetrics(body);
+    LatencyStats::getInstance().exportMetrics(body);
+    return body.str();
+}
+
+void MetricsServer::writeDump() {
+    // write-then-rename so the file-sync uploader never ships a half dump
+    std::string name = "metrics-" + std::to_string(Timebase::wallMs()) + ".prom";
+    std::string tmp = dumpDirectory + name + ".tmp";
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) {
+        return;
+    }
+    out << renderAll();
+    out.close();
+    ::rename(tmp.c_str(), (dumpDirectory + name).c_str());
+}
+
+void MetricsServer::threadProcedure() {
+#ifdef __linux__
+    // deliberately the lowest-priority thread in the process: a scrape or
+    // dump only ever runs on time the frame path didn't want
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+
+    if (port > 0) {
+        listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd >= 0) {
+            int opt = 1;
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = INADDR_ANY;
+            addr.sin_port = htons(port);
+            if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+                listen(listenFd, 2) < 0) {
+                std::cerr << "MetricsServer: could not listen on port " << port << std::endl;
+                close(listenFd);
+                listenFd = -1;
+            } else {
+                std::cout << "MetricsServer: serving /metrics on port " << port << std::endl;
+            }
+        }
+    }
+
+    int64_t nextDumpMs = PipelineWatchdog::nowMs() + DUMP_INTERVAL_MS;
+    while (running) {
+        if (listenFd >= 0) {
+            pollfd p{listenFd, POLLIN, 0};
+            if (::poll(&p, 1, 500) > 0 && (p.revents & POLLIN)) {
+                int fd = ::accept(listenFd, nullptr, nullptr);
+                if (fd >= 0) {
+                    // read (and discard) the request line; any GET gets the
+                    // full rendering, one response per connection
+                    char req[1024];
+                    ssize_t ignored = ::recv(fd, req, sizeof(req), 0);
+                    (void)ignored;
+                    std::string body = renderAll();
+                    std::string response =
+                        "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/plain; version=0.0.4\r\n"
+                        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                        "Connection: close\r\n"
+                        "\r\n" + body;
+                    ::send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+                    close(fd);
+                }
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+
+        if (!dumpDirectory.empty() && PipelineWatchdog::nowMs() >= nextDumpMs) {
+            writeDump();
+            nextDumpMs = PipelineWatchdog::nowMs() + DUMP_INTERVAL_MS;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/**
+ * Scrape endpoint for the metrics registry. One low-priority thread answers
+ * GET /metrics with the Prometheus text rendering of every registered
+ * counter, gauge and sampler plus the watchdog beats and latency quantiles;
+ * rendering, sampling closures and the socket work all run on this thread,
+ * so scraping never perturbs the frame path beyond its relaxed atomics.
+ *
+ * For offline runs (no chase car scraping over the link) the same rendering
+ * is dumped periodically into the file-sync directory, where it rides home
+ * with the telemetry segments.
+ */
+class MetricsServer {
+public:
+    // port 0 disables the endpoint; dumps still run if dumpDirectory is set
+    MetricsServer(int port, std::string dumpDirectory);
+    ~MetricsServer();
+
+    void start();
+    void stop();
+
+private:
+    void threadProcedure();
+    // full text rendering: registry + watchdog beats + latency quantiles
+    std::string renderAll();
+    void writeDump();
+
+    int port;
+    std::string dumpDirectory;
+    int listenFd = -1;
+
+    std::atomic<bool> running = false;
+    std::thread worker;
+
+    // cadence of the offline dump files
+    static constexpr int64_t DUMP_INTERVAL_MS = 60000;
+};
+
+#endif // METRICSSERVER_H
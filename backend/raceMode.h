@@ -0,0 +1,61 @@
+#ifndef RACEMODE_H
+#define RACEMODE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/**
+ * Pin the whole process image into RAM for jitter-free operation.
+ *
+ * Our worst frame-latency spikes correlate with page faults: first touches
+ * of freshly grown buffers, and under SD-card pressure even code pages being
+ * reclaimed and re-read from disk. mlockall(MCL_CURRENT | MCL_FUTURE) locks
+ * everything mapped so far - text, heap, the preallocated slabs - and makes
+ * every later mapping (log segments, thread stacks) arrive locked and
+ * populated, so the prefault of future buffers comes for free. Must run
+ * before the pipeline is constructed for that to cover the log mmaps; the
+ * frame pool additionally dirty-touches its slab (FramePool::prefault) since
+ * its heap pages predate nothing but still want a first touch off the hot
+ * path. What got locked is logged so the boot log shows whether the
+ * guarantee is actually in force. Locking needs CAP_IPC_LOCK (or a generous
+ * RLIMIT_MEMLOCK); a refusal is reported but never fatal - the pipeline runs
+ * the same, just with faultable pages.
+ */
+inline void engageRaceMode() {
+#ifdef __linux__
+    if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cout << "race mode: mlockall refused (needs CAP_IPC_LOCK / root);"
+                  << " pages stay faultable" << std::endl;
+        return;
+    }
+    // VmLck from /proc/self/status is the kernel's own count of what pinned
+    long lockedKb = -1;
+    FILE* fp = fopen("/proc/self/status", "r");
+    if (fp != nullptr) {
+        char line[128];
+        while (fgets(line, sizeof(line), fp) != nullptr) {
+            if (strncmp(line, "VmLck:", 6) == 0) {
+                lockedKb = strtol(line + 6, nullptr, 10);
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    if (lockedKb >= 0) {
+        std::cout << "race mode: " << lockedKb
+                  << " kB locked resident, future mappings lock on arrival"
+                  << std::endl;
+    } else {
+        std::cout << "race mode: memory locked (current + future mappings)"
+                  << std::endl;
+    }
+#endif
+}
+
+#endif // RACEMODE_H
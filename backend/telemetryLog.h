@@ -0,0 +1,279 @@
+#ifndef TELEMETRYLOG_H
+#define TELEMETRYLOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Indexed on-disk telemetry log: fixed-width frame records keyed by the
+ * frame's tstamp_unix field, one mmap-preallocated segment at a time, plus a
+ * sparse (timestamp, record index) sidecar index per segment. Because records
+ * are fixed width and timestamps monotonic, a reader can answer a time-range
+ * query with one index probe and a short binary search instead of re-parsing
+ * <bsr>-tagged blobs linearly.
+ *
+ * Segment layout: TelemetryLogHeader, then recordSize-byte records packed
+ * back to back. Sidecar <segment>.idx: TelemetryLogIndexEntry every
+ * indexStride records. All integers little-endian (we only run on LE).
+ */
+
+struct TelemetryLogHeader {
+    char magic[4];          // "BLOG"
+    uint32_t version;       // bump on layout change
+    uint32_t recordSize;    // bytes per record (one frame)
+    uint32_t tstampOffset;  // offset of the uint64 unix-ms timestamp in a record
+    uint32_t layoutHash;    // DataFormat::layoutHash() of the writing build
+    uint32_t indexStride;   // records between sidecar index entries
+};
+
+struct TelemetryLogIndexEntry {
+    uint64_t timestamp;
+    uint32_t recordIndex;
+    uint32_t reserved;
+};
+
+class TelemetryLogWriter {
+public:
+    TelemetryLogWriter(std::string directory, uint32_t recordSize, uint32_t tstampOffset,
+                       uint32_t layoutHash, uint32_t segmentRecords = 16384, uint32_t indexStride = 256)
+        : directory(std::move(directory)), recordSize(recordSize), tstampOffset(tstampOffset),
+          layoutHash(layoutHash), segmentRecords(segmentRecords), indexStride(indexStride) {}
+
+    ~TelemetryLogWriter() {
+        closeSegment();
+    }
+
+    TelemetryLogWriter(const TelemetryLogWriter&) = delete;
+    TelemetryLogWriter& operator=(const TelemetryLogWriter&) = delete;
+
+    void append(const uint8_t* frame) {
+        if (base == nullptr || records >= segmentRecords) {
+            closeSegment();
+            if (!openSegment()) {
+                return;
+            }
+        }
+        std::memcpy(base + sizeof(TelemetryLogHeader) + (size_t)records * recordSize,
+                    frame, recordSize);
+        if (records % indexStride == 0) {
+            uint64_t ts;
+            std::memcpy(&ts, frame + tstampOffset, sizeof(ts));
+            index.push_back({ts, records, 0});
+        }
+        records++;
+    }
+
+private:
+    bool openSegment() {
+        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        segmentPath = directory + std::to_string(now) + ".blog";
+        fd = ::open(segmentPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        mappedBytes = sizeof(TelemetryLogHeader) + (size_t)segmentRecords * recordSize;
+        if (::ftruncate(fd, (off_t)mappedBytes) != 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        void* map = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        base = (uint8_t*)map;
+        records = 0;
+        index.clear();
+
+        TelemetryLogHeader header{};
+        std::memcpy(header.magic, "BLOG", 4);
+        header.version = 1;
+        header.recordSize = recordSize;
+        header.tstampOffset = tstampOffset;
+        header.layoutHash = layoutHash;
+        header.indexStride = indexStride;
+        std::memcpy(base, &header, sizeof(header));
+        return true;
+    }
+
+    void closeSegment() {
+        if (base == nullptr) {
+            return;
+        }
+        size_t used = sizeof(TelemetryLogHeader) + (size_t)records * recordSize;
+        ::msync(base, used, MS_ASYNC);
+        ::munmap(base, mappedBytes);
+        ::ftruncate(fd, (off_t)used);
+        ::close(fd);
+        base = nullptr;
+        fd = -1;
+
+        // the sidecar index is tiny, a plain write at rotation is fine
+        int ifd = ::open((segmentPath + ".idx").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (ifd >= 0) {
+            ssize_t ignored = ::write(ifd, index.data(), index.size() * sizeof(TelemetryLogIndexEntry));
+            (void)ignored;
+            ::close(ifd);
+        }
+        index.clear();
+    }
+
+    std::string directory;
+    uint32_t recordSize;
+    uint32_t tstampOffset;
+    uint32_t layoutHash;
+    uint32_t segmentRecords;
+    uint32_t indexStride;
+
+    std::string segmentPath;
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    uint32_t records = 0;
+    std::vector<TelemetryLogIndexEntry> index;
+};
+
+class TelemetryLogReader {
+public:
+    TelemetryLogReader() = default;
+
+    ~TelemetryLogReader() {
+        close();
+    }
+
+    TelemetryLogReader(const TelemetryLogReader&) = delete;
+    TelemetryLogReader& operator=(const TelemetryLogReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TelemetryLogHeader)) {
+            close();
+            return false;
+        }
+        mappedBytes = (size_t)st.st_size;
+        void* map = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base = (const uint8_t*)map;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, "BLOG", 4) != 0 || header.version != 1 ||
+            header.recordSize == 0) {
+            close();
+            return false;
+        }
+        records = (mappedBytes - sizeof(TelemetryLogHeader)) / header.recordSize;
+        loadIndex(path + ".idx");
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) {
+            ::munmap((void*)base, mappedBytes);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        records = 0;
+        index.clear();
+    }
+
+    size_t recordCount() const { return records; }
+    const TelemetryLogHeader& segmentHeader() const { return header; }
+
+    const uint8_t* record(size_t i) const {
+        return base + sizeof(TelemetryLogHeader) + i * header.recordSize;
+    }
+
+    uint64_t timestampAt(size_t i) const {
+        uint64_t ts;
+        std::memcpy(&ts, record(i) + header.tstampOffset, sizeof(ts));
+        return ts;
+    }
+
+    /**
+     * Index of the first record with timestamp >= ts: one sparse-index probe
+     * to bound the search, then binary search within a stride.
+     */
+    size_t lowerBound(uint64_t ts) const {
+        size_t lo = 0;
+        size_t hi = records;
+        // narrow [lo, hi) with the sparse index first
+        if (!index.empty()) {
+            size_t ilo = 0;
+            size_t ihi = index.size();
+            while (ilo < ihi) {
+                size_t mid = (ilo + ihi) / 2;
+                if (index[mid].timestamp < ts) {
+                    ilo = mid + 1;
+                } else {
+                    ihi = mid;
+                }
+            }
+            lo = ilo == 0 ? 0 : index[ilo - 1].recordIndex;
+            hi = ilo < index.size() ? index[ilo].recordIndex + 1 : records;
+        }
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (timestampAt(mid) < ts) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    /**
+     * Record span [first, last) whose timestamps fall in [startTs, endTs].
+     */
+    void queryRange(uint64_t startTs, uint64_t endTs, size_t& first, size_t& last) const {
+        first = lowerBound(startTs);
+        last = lowerBound(endTs + 1);
+    }
+
+private:
+    void loadIndex(const std::string& path) {
+        int ifd = ::open(path.c_str(), O_RDONLY);
+        if (ifd < 0) {
+            return; // index is an accelerator, not a requirement
+        }
+        struct stat st{};
+        if (::fstat(ifd, &st) == 0 && st.st_size > 0 &&
+            st.st_size % sizeof(TelemetryLogIndexEntry) == 0) {
+            index.resize(st.st_size / sizeof(TelemetryLogIndexEntry));
+            if (::read(ifd, index.data(), st.st_size) != st.st_size) {
+                index.clear();
+            }
+        }
+        ::close(ifd);
+    }
+
+    int fd = -1;
+    const uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    size_t records = 0;
+    TelemetryLogHeader header{};
+    std::vector<TelemetryLogIndexEntry> index;
+};
+
+#endif // TELEMETRYLOG_H
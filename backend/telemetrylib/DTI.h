@@ -10,6 +10,7 @@
 #include <functional>
 #include <cstdint>
 #include <unistd.h>
+#include "frame.h"
 
 // Network socket state enum (replacement for QAbstractSocket::SocketState)
 enum class SocketState {
@@ -31,11 +32,46 @@ public:
     virtual ~DTI() = default;
     
     /**
-     * Send bytes via channel to be implemented, do not record data in this function.
-     * @param bytes data buffer to send
-     * @param timestamp when the data was created
+     * Send one frame via channel to be implemented, do not record data in
+     * this function. The frame is shared and immutable - keep a FramePtr if
+     * the bytes are needed beyond this call, never copy them to mutate.
      */
-    virtual void sendData(const std::vector<uint8_t>& bytes, long long timestamp) = 0;
+    virtual void sendData(const FramePtr& frame) = 0;
+
+    /**
+     * Depth of this channel's send queue - effectively its drop policy.
+     * Frames beyond this are dropped oldest-first. Channels that must stay
+     * fresh (chase car UDP) keep this small; channels that can batch and
+     * catch up (cloud SQL) keep it large.
+     */
+    virtual size_t queueCapacity() const { return 64; }
+
+    /**
+     * Short channel name for logs and latency stats.
+     */
+    virtual const char* name() const { return "DTI"; }
+
+    /**
+     * Rate-controlled channels go through token-bucket admission in
+     * Telemetry: frames beyond the admitted rate are decimated at enqueue
+     * time, and the rate adapts down when the link can't keep up. Links
+     * that are effectively free (local UDP/TCP) leave this false and get
+     * every frame.
+     */
+    virtual bool rateControlled() const { return false; }
+
+    /**
+     * Durable channels gate the write-ahead log cursor: a frame is only
+     * acknowledged to the WAL once every durable channel has pushed it out.
+     * Fire-and-forget channels (UDP, TCP dashboards) leave this false.
+     */
+    virtual bool durable() const { return false; }
+
+    /**
+     * Frames accepted by sendData but still held in memory (e.g. an unsent
+     * batch). The WAL keeps these unacknowledged so a crash replays them.
+     */
+    virtual size_t unsentFrames() const { return 0; }
     
     /**
      * Set callback for connection status changes
@@ -0,0 +1,208 @@
+#include "binaryUplink.h"
+#include "Config.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/timebase.h"
+
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static long long nowMs() {
+    return Timebase::wallMs();
+}
+
+BinaryUplink::BinaryUplink(std::string sessionName) : sessionName(std::move(sessionName)) {
+    const Config::Settings& settings = Config::getInstance().settings();
+    serverUrl = settings.sqlServerUrl;
+    port = settings.uplinkPort;
+    transferTimeout = settings.sqlTransferTimeout;
+    retryInterval = settings.sqlRetryInterval;
+
+    // No connect here: like SQL, the first dial happens in sendData() on the
+    // channel worker, so a slow uplink handshake can't hold up the backend
+    // thread's boot (lastRetry = 0 makes the first frame attempt it at once)
+}
+
+BinaryUplink::~BinaryUplink() {
+    closeConnection();
+}
+
+void BinaryUplink::sendData(const FramePtr& frame) {
+    // every frame enters the pending window first, so a send failure or a
+    // dead link just leaves it queued for the next reconnect
+    if (pending.size() >= MAX_PENDING) {
+        pending.pop_front();
+    }
+    pending.push_back({nextSeq++, frame->timestamp, frame});
+
+    long long now = nowMs();
+    if (fd < 0 && now - lastRetry < retryInterval) {
+        return; // link known down, don't hammer connect()
+    }
+    bool wasConnected = fd >= 0;
+    if (!ensureConnected()) {
+        lastRetry = now;
+        return;
+    }
+
+    // a fresh connection already resent the whole window (newest included);
+    // on an established one only the newest record still needs to go out
+    if (wasConnected) {
+        const Pending& newest = pending.back();
+        if (!sendRecord(newest.seq, newest.timestampMs, newest.frame->data)) {
+            closeConnection();
+            lastRetry = now;
+            return;
+        }
+    }
+
+    drainAcks();
+}
+
+bool BinaryUplink::ensureConnected() {
+    if (fd >= 0) {
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(serverUrl.c_str(), std::to_string(port).c_str(), &hints, &res) != 0 || res == nullptr) {
+        return false;
+    }
+
+    fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        fd = -1;
+        return false;
+    }
+
+    timeval tv{transferTimeout / 1000, (transferTimeout % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    bool ok = ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        closeConnection();
+        return false;
+    }
+
+    // hello / reply: the one blocking round trip per connection
+    std::vector<uint8_t> hello;
+    hello.insert(hello.end(), {'B', 'U', 'P', 'L'});
+    uint32_t version = 1;
+    hello.insert(hello.end(), (uint8_t*)&version, (uint8_t*)&version + sizeof(version));
+    // the server rejects a session whose frame layout it can't decode
+    uint32_t layoutHash = DataFormat::layoutHash();
+    hello.insert(hello.end(), (uint8_t*)&layoutHash, (uint8_t*)&layoutHash + sizeof(layoutHash));
+    uint32_t nameLen = (uint32_t)sessionName.size();
+    hello.insert(hello.end(), (uint8_t*)&nameLen, (uint8_t*)&nameLen + sizeof(nameLen));
+    hello.insert(hello.end(), sessionName.begin(), sessionName.end());
+    if (::send(fd, hello.data(), hello.size(), MSG_NOSIGNAL) != (ssize_t)hello.size()) {
+        closeConnection();
+        return false;
+    }
+
+    uint8_t reply[8];
+    size_t got = 0;
+    while (got < sizeof(reply)) {
+        ssize_t n = ::recv(fd, reply + got, sizeof(reply) - got, 0);
+        if (n <= 0) {
+            closeConnection();
+            return false;
+        }
+        got += (size_t)n;
+    }
+    uint32_t status;
+    std::memcpy(&status, reply + 4, sizeof(status));
+    if (std::memcmp(reply, "BUPL", 4) != 0 || status != 0) {
+        std::cout << "Uplink: server refused session " << sessionName << std::endl;
+        closeConnection();
+        return false;
+    }
+
+    std::cout << "Uplink: connected, session " << sessionName
+              << ", resending " << pending.size() << " pending frame(s)" << std::endl;
+    ackBuf.clear();
+    handshaken = true;
+
+    // resend the unacked window; the server dedups by sequence
+    for (const Pending& p : pending) {
+        if (!sendRecord(p.seq, p.timestampMs, p.frame->data)) {
+            closeConnection();
+            return false;
+        }
+    }
+    return true;
+}
+
+void BinaryUplink::closeConnection() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    handshaken = false;
+}
+
+bool BinaryUplink::sendRecord(uint64_t seq, long long timestampMs, const std::vector<uint8_t>& bytes) {
+    uint8_t header[1 + sizeof(uint64_t) + sizeof(int64_t) + sizeof(uint32_t)];
+    header[0] = 0x01;
+    std::memcpy(header + 1, &seq, sizeof(seq));
+    int64_t ts = (int64_t)timestampMs;
+    std::memcpy(header + 9, &ts, sizeof(ts));
+    uint32_t len = (uint32_t)bytes.size();
+    std::memcpy(header + 17, &len, sizeof(len));
+
+    iovec iov[2] = {{header, sizeof(header)},
+                    {const_cast<uint8_t*>(bytes.data()), bytes.size()}};
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    return ::sendmsg(fd, &msg, MSG_NOSIGNAL) == (ssize_t)(sizeof(header) + bytes.size());
+}
+
+void BinaryUplink::drainAcks() {
+    uint8_t buf[256];
+    while (true) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n == 0) { // server closed
+            closeConnection();
+            break;
+        }
+        if (n < 0) {
+            break; // EAGAIN - nothing more pending
+        }
+        ackBuf.insert(ackBuf.end(), buf, buf + n);
+    }
+
+    // acks are cumulative, so only the last complete one matters
+    size_t pos = 0;
+    uint64_t acked = 0;
+    bool haveAck = false;
+    while (pos + 9 <= ackBuf.size()) {
+        if (ackBuf[pos] != 0x02) { // protocol violation, start over
+            closeConnection();
+            ackBuf.clear();
+            return;
+        }
+        std::memcpy(&acked, ackBuf.data() + pos + 1, sizeof(acked));
+        haveAck = true;
+        pos += 9;
+    }
+    ackBuf.erase(ackBuf.begin(), ackBuf.begin() + pos);
+
+    if (haveAck) {
+        while (!pending.empty() && pending.front().seq <= acked) {
+            pending.pop_front();
+        }
+    }
+}
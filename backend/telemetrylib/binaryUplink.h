@@ -0,0 +1,86 @@
+#ifndef TELEMETRYLIB_BINARYUPLINK_H
+#define TELEMETRYLIB_BINARYUPLINK_H
+
+#include "DTI.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * Cloud uplink speaking a persistent binary protocol instead of HTTP.
+ *
+ * Over the cellular link each HTTP request costs headers plus (on
+ * reconnect) a full connection setup at ~300 ms RTT; this channel holds
+ * one TCP connection open and pipelines length-prefixed frame records
+ * down it without waiting for replies. The server acks cumulatively by
+ * sequence number, so delivery is confirmed without a per-frame round
+ * trip and anything unacked at reconnect is resent. Selected with
+ * "uplink_mode": "binary" in config.json; the HTTP path (sql.h) remains
+ * the default and the fallback.
+ *
+ * Wire format (all integers little-endian):
+ *   hello:  "BUPL" u32 version  u32 layoutHash  u32 nameLen  name bytes
+ *   reply:  "BUPL" u32 status (0 = ok)
+ *   frame:  u8 0x01  u64 sequence  s64 timestampMs  u32 len  frame bytes
+ *   ack:    u8 0x02  u64 sequence (everything <= sequence is stored)
+ */
+class BinaryUplink : public DTI {
+public:
+    explicit BinaryUplink(std::string sessionName);
+    ~BinaryUplink();
+
+    void sendData(const FramePtr& frame) override;
+
+    // same drop policy as the HTTP cloud channel: deep queue, catch up later
+    size_t queueCapacity() const override { return 256; }
+
+    const char* name() const override { return "Uplink"; }
+
+    // frames stay unacknowledged to the WAL until the server acks them, so
+    // a crash (ours or the link's) replays instead of losing them
+    bool durable() const override { return true; }
+    size_t unsentFrames() const override { return pending.size(); }
+
+    bool rateControlled() const override { return true; }
+
+private:
+    // Connect, handshake and resend anything the server never acked
+    bool ensureConnected();
+    void closeConnection();
+
+    // Write one frame record on the persistent connection
+    bool sendRecord(uint64_t seq, long long timestampMs, const std::vector<uint8_t>& bytes);
+
+    // Consume whatever acks have arrived (non-blocking) and drop the
+    // acked prefix of the pending window
+    void drainAcks();
+
+    std::string serverUrl;
+    int port;
+    int transferTimeout;
+    int retryInterval;
+    std::string sessionName;
+
+    int fd = -1;
+    bool handshaken = false;
+    long long lastRetry = 0;
+
+    uint64_t nextSeq = 1;
+
+    // sent (or queued for resend) but not yet acked, oldest first
+    struct Pending {
+        uint64_t seq;
+        long long timestampMs;
+        FramePtr frame;
+    };
+    std::deque<Pending> pending;
+
+    // partial ack message straddling two reads
+    std::vector<uint8_t> ackBuf;
+
+    // bound on the resend window while the link is down; beyond this the
+    // oldest frames are abandoned, same trade the HTTP batch path makes
+    static constexpr size_t MAX_PENDING = 1024;
+};
+
+#endif //TELEMETRYLIB_BINARYUPLINK_H
@@ -0,0 +1,38 @@
+#ifndef TELEMETRYLIB_FRAME_H
+#define TELEMETRYLIB_FRAME_H
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * One immutable telemetry frame: the raw bytes plus the wall timestamp they
+ * were stamped with. Allocated once per cycle in BackendProcesses and then
+ * shared by reference through Telemetry and every DTI, so fanning a frame out
+ * to three channels costs three atomic increments instead of three kilobyte
+ * memcpys. Channels that need framing (<bsr> tags, delta headers) add it via
+ * scatter-gather at send time; nobody mutates the payload.
+ */
+class Frame {
+public:
+    Frame(std::vector<uint8_t>&& bytes, long long timestamp)
+        : data(std::move(bytes)), timestamp(timestamp) {}
+
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
+
+    // not declared const so the frame pool can reclaim the buffer when the
+    // last reference dies; immutability is enforced by FramePtr pointing to
+    // const Frame
+    std::vector<uint8_t> data;
+    long long timestamp;
+};
+
+using FramePtr = std::shared_ptr<const Frame>;
+
+inline FramePtr makeFrame(std::vector<uint8_t> bytes, long long timestamp) {
+    return std::make_shared<const Frame>(std::move(bytes), timestamp);
+}
+
+#endif // TELEMETRYLIB_FRAME_H
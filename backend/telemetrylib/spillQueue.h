@@ -0,0 +1,204 @@
+#ifndef TELEMETRYLIB_SPILLQUEUE_H
+#define TELEMETRYLIB_SPILLQUEUE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Bounded disk-backed FIFO of frames for a downed uplink.
+ *
+ * Records are appended to rotating segment files; a reader consumes them
+ * oldest-first and unlinks each segment once drained. When the total size
+ * exceeds the budget the oldest segment is dropped whole - a long enough
+ * outage costs the start of the backlog, never the disk. The backlog
+ * survives a restart: segments found on boot are replayed from their
+ * beginning, so a crash mid-drain re-uploads a few records rather than
+ * losing any (the server keys rows by timestamp, duplicates are benign).
+ *
+ * Record format: [int64 timestamp ms][uint32 length][payload].
+ * Single-threaded by design - the owning channel worker is the only caller.
+ */
+class SpillQueue {
+public:
+    explicit SpillQueue(const std::string& directory,
+                        size_t maxBytes = 256u << 20, size_t segmentBytes = 4u << 20)
+        : dir(directory), maxBytes(maxBytes), segmentBytes(segmentBytes) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+
+        // resume a backlog a previous run left behind
+        std::vector<uint32_t> found;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            unsigned idx;
+            if (sscanf(entry.path().filename().string().c_str(), "spill-%u.seg", &idx) == 1) {
+                found.push_back((uint32_t)idx);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        for (uint32_t idx : found) {
+            std::error_code sec;
+            size_t size = (size_t)std::filesystem::file_size(segmentPath(idx), sec);
+            segments.push_back({idx, sec ? 0 : size});
+            totalBytes += segments.back().bytes;
+        }
+        nextIndex = found.empty() ? 1 : found.back() + 1;
+    }
+
+    ~SpillQueue() {
+        if (writeFd >= 0) ::close(writeFd);
+        if (readFd >= 0) ::close(readFd);
+    }
+
+    SpillQueue(const SpillQueue&) = delete;
+    SpillQueue& operator=(const SpillQueue&) = delete;
+
+    void push(long long timestampMs, const std::vector<uint8_t>& bytes) {
+        if (writeFd < 0 || segments.empty() || segments.back().bytes >= segmentBytes) {
+            if (writeFd >= 0) {
+                ::close(writeFd);
+                writeFd = -1;
+            }
+            writeFd = ::open(segmentPath(nextIndex).c_str(),
+                             O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (writeFd < 0) {
+                return;
+            }
+            segments.push_back({nextIndex++, 0});
+        }
+
+        scratch.clear();
+        int64_t ts = (int64_t)timestampMs;
+        uint32_t len = (uint32_t)bytes.size();
+        scratch.insert(scratch.end(), (uint8_t*)&ts, (uint8_t*)&ts + sizeof(ts));
+        scratch.insert(scratch.end(), (uint8_t*)&len, (uint8_t*)&len + sizeof(len));
+        scratch.insert(scratch.end(), bytes.begin(), bytes.end());
+        if (::write(writeFd, scratch.data(), scratch.size()) != (ssize_t)scratch.size()) {
+            return;
+        }
+        segments.back().bytes += scratch.size();
+        totalBytes += scratch.size();
+
+        // over budget: the oldest segment goes whole, keeping the newest data
+        while (totalBytes > maxBytes && segments.size() > 1) {
+            dropFront();
+        }
+    }
+
+    // Pop the oldest record; false when the queue is drained
+    bool pop(long long& timestampMs, std::vector<uint8_t>& bytes) {
+        while (!segments.empty()) {
+            if (readFd < 0) {
+                readFd = ::open(segmentPath(segments.front().index).c_str(), O_RDONLY);
+                if (readFd < 0) {
+                    dropFront();
+                    continue;
+                }
+                readOffset = 0;
+            }
+
+            uint8_t hdr[sizeof(int64_t) + sizeof(uint32_t)];
+            ssize_t n = ::pread(readFd, hdr, sizeof(hdr), (off_t)readOffset);
+            if (n != (ssize_t)sizeof(hdr)) {
+                if (segments.size() == 1) {
+                    return false; // caught up with the writer
+                }
+                dropFront(); // this segment is done, move on
+                continue;
+            }
+            int64_t ts;
+            uint32_t len;
+            std::memcpy(&ts, hdr, sizeof(ts));
+            std::memcpy(&len, hdr + sizeof(ts), sizeof(len));
+            if (len > segmentBytes) { // torn or corrupt record: abandon segment
+                if (segments.size() == 1) {
+                    dropFront();
+                    return false;
+                }
+                dropFront();
+                continue;
+            }
+            bytes.resize(len);
+            if (::pread(readFd, bytes.data(), len, (off_t)(readOffset + sizeof(hdr))) != (ssize_t)len) {
+                if (segments.size() == 1) {
+                    return false;
+                }
+                dropFront();
+                continue;
+            }
+            readOffset += sizeof(hdr) + len;
+            timestampMs = (long long)ts;
+
+            // a fully drained single segment can be reclaimed right away
+            if (segments.size() == 1 && readOffset >= segments.front().bytes &&
+                segments.front().bytes >= segmentBytes) {
+                dropFront();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool empty() const {
+        if (segments.empty()) {
+            return true;
+        }
+        if (segments.size() == 1 && readFd >= 0 && readOffset >= segments.front().bytes) {
+            return true;
+        }
+        return false;
+    }
+
+    size_t pendingBytes() const { return totalBytes - std::min(totalBytes, readOffset); }
+
+private:
+    struct Segment {
+        uint32_t index;
+        size_t bytes;
+    };
+
+    std::string segmentPath(uint32_t index) const {
+        char name[32];
+        snprintf(name, sizeof(name), "spill-%06u.seg", index);
+        return dir + name;
+    }
+
+    void dropFront() {
+        if (readFd >= 0) {
+            ::close(readFd);
+            readFd = -1;
+        }
+        if (segments.front().index + 1 == nextIndex && writeFd >= 0) {
+            ::close(writeFd); // dropping the segment being written
+            writeFd = -1;
+        }
+        totalBytes -= std::min(totalBytes, segments.front().bytes);
+        ::unlink(segmentPath(segments.front().index).c_str());
+        segments.pop_front();
+        readOffset = 0;
+    }
+
+    std::string dir;
+    const size_t maxBytes;
+    const size_t segmentBytes;
+
+    std::deque<Segment> segments;
+    uint32_t nextIndex = 1;
+    size_t totalBytes = 0;
+
+    int writeFd = -1;
+    int readFd = -1;
+    size_t readOffset = 0;
+
+    std::vector<uint8_t> scratch;
+};
+
+#endif //TELEMETRYLIB_SPILLQUEUE_H
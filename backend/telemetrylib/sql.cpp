@@ -2,129 +2,311 @@
 // Created by Mingcan Li on 2/3/23.
 //
 
-#include "DTI.h"
-#include <thread>
+#include "sql.h"
 #include "Config.h"
+#include "backend/timebase.h"
+#include "3rdparty/rapidjson/document.h"
 
-class SQL : public DTI {
-public:
-    
-    SQL(QString tableToCreate) {
-        this->tableToCreate = tableToCreate;
-
-        restclient = new QNetworkAccessManager();
-        // Send request to create a new table when connection to server is first established
-        if(tableName.isNull()) {
-            qDebug() << "Requested a new table: " << tableToCreate;
-
-            QUrl myurl;
-            myurl.setScheme("http");
-            myurl.setHost(serverUrl); 
-            myurl.setPath("/add-table/" + tableToCreate);
-
-            request.setUrl(myurl);
-            
-            int transferTimeout = Config::getInstance().getConfig()["sql_transfer_timeout"].toInt();
-            request.setTransferTimeout(transferTimeout);
-
-            
-            
-            reply = restclient->get(request);
-
-            connect(reply, &QNetworkReply::readyRead, this, &SQL::readReply);
-            request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("arraybuffer"));
-            request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
-            lastRetry = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static long long nowMs() {
+    return Timebase::wallMs();
+}
+
+SQL::SQL(std::string tableToCreate)
+    : spill(std::filesystem::temp_directory_path().string() + "/driver-io-spill/") {
+    this->tableToCreate = tableToCreate;
+
+    // Resolve the server address and tunables once; sendData runs per frame
+    // and should not be re-reading config on the hot path
+    const Config::Settings& settings = Config::getInstance().settings();
+    serverUrl = settings.sqlServerUrl;
+    transferTimeout = settings.sqlTransferTimeout;
+    retryInterval = settings.sqlRetryInterval;
+    batchFrames = settings.sqlBatchFrames;
+    batchWindowMs = settings.sqlBatchWindowMs;
+    configGen = Config::getInstance().generation();
+
+    // No network here: the table-create handshake runs from sendData() on
+    // this channel's worker thread, at the first frame. Over weak cellular
+    // that request alone can take seconds, and this constructor used to sit
+    // on the backend thread's boot path - the whole frame pipeline waited
+    // behind it. Now the channel attaches late and only its own queue backs
+    // up while it does (lastRetry = 0 makes the first sendData try at once).
+}
+
+SQL::~SQL() {
+    if (batchCount > 0) {
+        flushBatch();
+    }
+    closeConnection();
+}
+
+void SQL::requestNewTable() {
+    std::cout << "Requesting a new table: " << tableToCreate << std::endl;
+    if (httpRequest("GET", "/add-table/" + tableToCreate, nullptr, lastResponse)) {
+        readReply();
+    }
+}
+
+void SQL::sendData(const FramePtr& frame) {
+    long long now = nowMs();
+    if(tableName.empty() && now - lastRetry > retryInterval) {
+        std::cout << "Retrying to add a new table: " << tableToCreate << std::endl;
+        requestNewTable();
+        lastRetry = now;
+    } else if(!tableName.empty()) {
+        if (batchCount == 0) {
+            batchStartMs = now;
+            batchFirstTimestamp = frame->timestamp;
         }
+        appendToBatch(frame->data, frame->timestamp);
+
+        // One POST per N frames or T milliseconds, whichever comes first,
+        // instead of one connection + request per frame
+        if (batchCount >= batchFrames || now - batchStartMs >= batchWindowMs) {
+            flushBatch();
+        }
+    }
+}
+
+void SQL::appendToBatch(const std::vector<uint8_t>& bytes, long long timestamp) {
+    // Each frame is length-prefixed (uint32 little-endian) so the server can
+    // split the batch without scanning for tags
+    uint32_t len = (uint32_t)bytes.size();
+    batch.push_back((uint8_t)(len & 0xFF));
+    batch.push_back((uint8_t)((len >> 8) & 0xFF));
+    batch.push_back((uint8_t)((len >> 16) & 0xFF));
+    batch.push_back((uint8_t)((len >> 24) & 0xFF));
+    batchIndex.push_back({timestamp, batch.size(), bytes.size()});
+    batch.insert(batch.end(), bytes.begin(), bytes.end());
+    batchCount++;
+}
+
+void SQL::refreshSettings() {
+    uint64_t now = Config::getInstance().generation();
+    if (now == configGen) {
+        return;
+    }
+    configGen = now;
+    std::shared_ptr<const Config::Settings> settings = Config::getInstance().snapshot();
+    if (serverUrl != settings->sqlServerUrl) {
+        serverUrl = settings->sqlServerUrl;
+        closeConnection(); // next request dials the new server
     }
+    transferTimeout = settings->sqlTransferTimeout;
+    retryInterval = settings->sqlRetryInterval;
+    batchFrames = settings->sqlBatchFrames;
+    batchWindowMs = settings->sqlBatchWindowMs;
+    std::cout << "SQL: applied reloaded config" << std::endl;
+}
 
-    ~SQL() {
-        finish = true;
-        t->join();
-    }
-
-    void sendData(QByteArray bytes, long long timestamp) override {
-        int transferTimeout = Config::getInstance().getConfig()["sql_transfer_timeout"].toInt();
-        int retryInterval = Config::getInstance().getConfig()["sql_retry_interval"].toInt();
-        qDebug()<<"sending Via SQL: "<<timestamp;
-        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        if(tableName.isNull() && now - lastRetry > retryInterval) {
-            qDebug() << "Retrying to add a new table: " << tableToCreate;
-
-            QUrl myurl;
-            myurl.setScheme("http");
-            myurl.setHost(serverUrl); 
-            myurl.setPath("/add-table/" + tableToCreate);
-
-            request.setUrl(myurl);
-            request.setTransferTimeout(transferTimeout);
-            reply = restclient->get(request);
-
-            connect(reply, &QNetworkReply::readyRead, this, &SQL::readReply);
-            request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("arraybuffer"));
-            request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
-            lastRetry = now;
-        } else {
-            QUrl myurl;
-            myurl.setScheme("http");
-            myurl.setHost(serverUrl);
-            myurl.setPath("/add-data");
-            myurl.setQuery("table-name=" + tableName + "&dataset-time=" + QString::fromStdString(std::to_string(timestamp)));
-            //QNetworkRequest request;
-            request.setUrl(myurl);
-            request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("arraybuffer"));
-            request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
-            request.setTransferTimeout(transferTimeout);
-            bytes.push_front("<bsr>");
-            bytes.push_back("</bsr>");
-            this->restclient->post(request, bytes);
+void SQL::flushBatch() {
+    refreshSettings();
+    std::cout << "sending Via SQL: " << batchCount << " frames from " << batchFirstTimestamp << std::endl;
+    bool ok = httpRequest("POST", "/add-data-batch?table-name=" + tableName
+                              + "&dataset-time=" + std::to_string(batchFirstTimestamp)
+                              + "&count=" + std::to_string(batchCount),
+                          &batch, lastResponse);
+    if (!ok) {
+        // link down: spill the batch to disk so the outage leaves no hole in
+        // the cloud record, just a delay
+        if (linkUp) {
+            std::cout << "SQL: link down, spilling frames to disk" << std::endl;
         }
+        std::vector<uint8_t> record;
+        for (const BatchEntry& entry : batchIndex) {
+            record.assign(batch.begin() + entry.offset,
+                          batch.begin() + entry.offset + entry.length);
+            spill.push(entry.timestamp, record);
+        }
+    }
+    linkUp = ok;
+    batch.clear();
+    batchIndex.clear();
+    batchCount = 0;
+
+    // the link just proved itself; stream some backlog behind the live data
+    if (ok && !spill.empty()) {
+        catchUp();
     }
+}
 
-    /*
-     std::string receiveData() override{
-        QJsonObject json = QJsonDocument::fromJson(reply->readAll()).object();
-        if (json.isEmpty()) {
-            qDebug() << "EMPTY JSON";
-            return "nada";
-        } else {
-            tableName = json.take("response").toString();
-            qDebug() << "HTTP response (table name): " << tableName;
-            return tableName.toStdString();
-            // TODO Automatically delete server responses since they aren't used after reading the table name
-            this->restclient->setAutoDeleteReplies(true);
+void SQL::catchUp() {
+    // one batch of backlog per successful live flush: the replay is rate
+    // limited by the live traffic itself, so fresh data keeps priority
+    std::vector<std::pair<long long, std::vector<uint8_t>>> popped;
+    std::vector<uint8_t> body;
+    long long ts;
+    std::vector<uint8_t> record;
+    while ((int)popped.size() < batchFrames && spill.pop(ts, record)) {
+        uint32_t len = (uint32_t)record.size();
+        body.push_back((uint8_t)(len & 0xFF));
+        body.push_back((uint8_t)((len >> 8) & 0xFF));
+        body.push_back((uint8_t)((len >> 16) & 0xFF));
+        body.push_back((uint8_t)((len >> 24) & 0xFF));
+        body.insert(body.end(), record.begin(), record.end());
+        popped.emplace_back(ts, std::move(record));
+    }
+    if (popped.empty()) {
+        return;
+    }
+
+    std::cout << "SQL: catch-up, uploading " << popped.size()
+              << " spilled frame(s), " << spill.pendingBytes() << " bytes left" << std::endl;
+    if (!httpRequest("POST", "/add-data-batch?table-name=" + tableName
+                         + "&dataset-time=" + std::to_string(popped.front().first)
+                         + "&count=" + std::to_string(popped.size()),
+                     &body, lastResponse)) {
+        // link dropped again mid-replay: back onto disk they go. They land
+        // at the tail, but the server orders rows by timestamp anyway.
+        for (const auto& p : popped) {
+            spill.push(p.first, p.second);
         }
+        linkUp = false;
+    }
+}
+
+void SQL::readReply() {
+    std::cout << "read reply invoked" << std::endl;
+    rapidjson::Document json;
+    json.Parse(lastResponse.c_str());
+
+    if(json.HasParseError() || !json.IsObject() || !json.HasMember("response") || !json["response"].IsString()) {
+        std::cout << "EMPTY JSON" << std::endl;
+    } else {
+        tableName = json["response"].GetString();
+        std::cout << "HTTP response (table name): " << tableName << std::endl;
     }
-    */
-
-public slots:
-    /**
-     * Read response from the server. Specifically, reads the response to the request to
-     * add a new table on the server and sets tableName to the response.
-     */
-    void readReply() override {
-        qDebug()<<"read reply invoked";
-        QJsonObject json = QJsonDocument::fromJson(reply->readAll()).object();
-
-        if(json.isEmpty()) {
-            qDebug() << "EMPTY JSON";
-        } else {
-            tableName = json.take("response").toString();
-            qDebug() << "HTTP response (table name): " << tableName;
-
-            // TODO Automatically delete server responses since they aren't used after reading the table name
-            this->restclient->setAutoDeleteReplies(true);
+}
+
+bool SQL::ensureConnected() {
+    if (fd >= 0) {
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(serverUrl.c_str(), "80", &hints, &res) != 0 || res == nullptr) {
+        return false;
+    }
+
+    fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        fd = -1;
+        return false;
+    }
+
+    timeval tv{transferTimeout / 1000, (transferTimeout % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    bool ok = ::connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        closeConnection();
+        return false;
+    }
+    return true;
+}
+
+void SQL::closeConnection() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool SQL::httpRequest(const std::string& method, const std::string& path,
+                      const std::vector<uint8_t>* body, std::string& responseBody) {
+    std::string request = method + " " + path + " HTTP/1.1\r\n"
+        "Host: " + serverUrl + "\r\n"
+        "Content-Type: arraybuffer\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Length: " + std::to_string(body ? body->size() : 0) + "\r\n"
+        "\r\n";
+    if (body) {
+        request.append(reinterpret_cast<const char*>(body->data()), body->size());
+    }
+
+    responseBody.clear();
+
+    // Two attempts: the server (or an idle timeout) may have dropped the
+    // persistent connection since the last request, so reconnect once
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!ensureConnected()) {
+            continue;
+        }
+
+        if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) {
+            closeConnection();
+            continue;
+        }
+
+        // Keep-alive means the server won't close after replying, so the
+        // response is delimited by Content-Length rather than EOF
+        std::string response;
+        char buf[4096];
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = 0;
+        bool haveLength = false;
+        while (true) {
+            if (headerEnd != std::string::npos &&
+                response.size() - (headerEnd + 4) >= contentLength) {
+                break;
+            }
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                break;
+            }
+            response.append(buf, n);
+            if (headerEnd == std::string::npos) {
+                headerEnd = response.find("\r\n\r\n");
+                if (headerEnd != std::string::npos) {
+                    size_t pos = response.find("Content-Length:");
+                    if (pos == std::string::npos) {
+                        pos = response.find("content-length:");
+                    }
+                    if (pos != std::string::npos && pos < headerEnd) {
+                        contentLength = std::strtoul(response.c_str() + pos + 15, nullptr, 10);
+                        haveLength = true;
+                    }
+                }
+            }
+        }
+
+        if (headerEnd == std::string::npos) {
+            closeConnection();
+            continue;
+        }
+        responseBody = response.substr(headerEnd + 4,
+                                       haveLength ? contentLength : std::string::npos);
+        if (response.find("Connection: close") != std::string::npos ||
+            response.find("connection: close") != std::string::npos || !haveLength) {
+            closeConnection();
+        }
+        // the ack is the status line: only a 2xx means the server took the
+        // data. A complete 4xx/5xx (overload, missing table, proxy error)
+        // must report failure so flushBatch spills the batch instead of
+        // discarding it - same check the file-sync uploader makes before
+        // deleting a segment.
+        size_t space = response.find(' ');
+        if (space == std::string::npos || space + 1 >= headerEnd ||
+            response[space + 1] != '2') {
+            std::cout << "SQL: server refused request ("
+                      << response.substr(0, response.find("\r\n")) << ")" << std::endl;
+            return false;
         }
+        return true;
     }
-private:
-    QString serverUrl = Config::getInstance().getConfig()["sql_server_url"].toString();
-
-    long long lastRetry = 0;
-    QNetworkRequest request;
-    QNetworkAccessManager *restclient = NULL;
-    QNetworkReply *reply;
-    QString tableName; // James added this
-    QString tableToCreate; 
-    std::thread *t; // thread to check connection by pinging a website in the background
-    std::atomic<bool> finish=false; //for soft quiting the thread
-};
+    return false;
+}
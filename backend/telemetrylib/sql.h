@@ -0,0 +1,102 @@
+//
+// Created by Mingcan Li on 2/3/23.
+//
+
+#ifndef TELEMETRYLIB_SQL_H
+#define TELEMETRYLIB_SQL_H
+
+#include "DTI.h"
+#include "spillQueue.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+class SQL : public DTI {
+public:
+
+    explicit SQL(std::string tableToCreate);
+    ~SQL();
+
+    void sendData(const FramePtr& frame) override;
+
+    // the cloud link can fall behind and catch up, so queue deep
+    size_t queueCapacity() const override { return 256; }
+
+    const char* name() const override { return "SQL"; }
+
+    // This is the channel the WAL exists for; frames sitting in the unsent
+    // batch stay unacknowledged so a crash replays them
+    bool durable() const override { return true; }
+    size_t unsentFrames() const override { return (size_t)batchCount; }
+
+    // cellular uplink: better to ship a steady decimated rate than to queue
+    // full rate into a timeout
+    bool rateControlled() const override { return true; }
+
+    /**
+     * Read response from the server. Specifically, reads the response to the
+     * request to add a new table on the server and sets tableName to the response.
+     */
+    void readReply() override;
+
+private:
+    // Connect the persistent keep-alive socket if it isn't up
+    bool ensureConnected();
+    void closeConnection();
+
+    // Re-resolve tunables if the config was hot-reloaded; called once per
+    // flush (one atomic load when nothing changed), never per frame
+    void refreshSettings();
+
+    // One HTTP round trip on the persistent connection; reconnects once on
+    // failure. Returns false if the request could not be delivered.
+    bool httpRequest(const std::string& method, const std::string& path,
+                     const std::vector<uint8_t>* body, std::string& responseBody);
+
+    void requestNewTable();
+
+    // Accumulate one frame into the current batch (length-prefixed)
+    void appendToBatch(const std::vector<uint8_t>& bytes, long long timestamp);
+    // Upload and clear the current batch; spills it to disk on failure
+    void flushBatch();
+    // Upload one batch worth of spilled backlog after a successful live
+    // flush, so catch-up never outpaces live data
+    void catchUp();
+
+    std::string serverUrl;
+
+    // settings resolved once at construction, not per frame
+    int transferTimeout;
+    int retryInterval;
+    int batchFrames;    // flush after this many frames...
+    int batchWindowMs;  // ...or this many milliseconds, whichever first
+    uint64_t configGen; // config generation those were resolved against
+
+    int fd = -1; // persistent keep-alive connection
+
+    // current batch: [uint32 little-endian length][frame bytes] per frame
+    std::vector<uint8_t> batch;
+    int batchCount = 0;
+    long long batchStartMs = 0;
+    long long batchFirstTimestamp = 0;
+
+    // per-record timestamps and payload offsets of the current batch, kept
+    // so a failed flush can spill the frames individually
+    struct BatchEntry {
+        long long timestamp;
+        size_t offset; // of the payload inside `batch`
+        size_t length;
+    };
+    std::vector<BatchEntry> batchIndex;
+
+    // disk-backed backlog for link outages; drained by catchUp()
+    SpillQueue spill;
+    bool linkUp = true;
+
+    long long lastRetry = 0;
+    std::string lastResponse;
+    std::string tableName; // James added this
+    std::string tableToCreate;
+};
+
+#endif //TELEMETRYLIB_SQL_H
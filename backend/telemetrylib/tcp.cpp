@@ -2,111 +2,323 @@
 // Created by Mingcan Li on 1/22/23.
 // Commented by ChatGPT
 //
-#include "DTI.h"
+#include "tcp.h"
 #include "Config.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameCodec.h"
 
+#include <arpa/inet.h>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
-class TCP : public DTI {
-public:
-    void sendData(QByteArray bytes, long long timestamp) override {
-        qDebug()<<"sending via TCP";
-        bytes.push_front("<bsr>");
-        bytes.push_back("</bsr>");
-        for (QTcpSocket* socket : _sockets) {
-            socket->write(bytes);
-        }
-    }
+TCP::TCP(const std::string& addr, int port) {
+    _server = ::socket(AF_INET, SOCK_STREAM, 0);
+    int opt = 1;
+    setsockopt(_server, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
-    /*Nope
-    std::string receiveData() override {
-        if(_sockets.size() == 1) {
-            //change the read parameter if there's trouble with reading the data
-            return _sockets[0]->read(1000).data();
-        }
-        return "nada";
+    sockaddr_in bindAddr{};
+    bindAddr.sin_family = AF_INET;
+    bindAddr.sin_port = htons(port);
+    if (addr.empty() || inet_pton(AF_INET, addr.c_str(), &bindAddr.sin_addr) != 1) {
+        bindAddr.sin_addr.s_addr = INADDR_ANY;
+    }
+    if (bind(_server, reinterpret_cast<sockaddr*>(&bindAddr), sizeof(bindAddr)) < 0 ||
+        listen(_server, 4) < 0) {
+        std::cerr << "TCP: could not listen on port " << port << std::endl;
     }
-    */
 
-    bool getConnectionStatus() {
-        return connection;
+    acceptThread = std::thread(&TCP::acceptLoop, this);
+    checkThread = std::thread(&TCP::checkConnection, this);
+}
+
+TCP::~TCP() {
+    finish = true;
+    if (_server >= 0) {
+        ::shutdown(_server, SHUT_RDWR);
+    }
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+    if (checkThread.joinable()) {
+        checkThread.join();
     }
+    std::lock_guard<std::mutex> lock(_socketsMutex);
+    for (Peer& peer : _peers) {
+        close(peer.fd);
+    }
+    if (_server >= 0) {
+        close(_server);
+    }
+}
+
+// Wire size of one queued frame under the peer's negotiated framing
+static size_t wireSize(const FramePtr& frame, bool v2) {
+    // v2 header, or "<bsr>" + "</bsr>"
+    return frame->data.size() + (v2 ? FrameCodec::HEADER_BYTES : 11);
+}
+
+void TCP::sendData(const FramePtr& frame) {
+    std::lock_guard<std::mutex> lock(_socketsMutex);
+    size_t queuedTotal = 0;
+    for (auto it = _peers.begin(); it != _peers.end();) {
+        Peer& peer = *it;
+
+        // bounded coalescing queue with drop-oldest: a slow peer loses its
+        // own oldest frames, never anyone else's freshness. The front frame
+        // is spared while partially sent so the tag stream stays aligned.
+        while (peer.queuedBytes + wireSize(frame, peer.v2) > MAX_QUEUED_BYTES &&
+               peer.queue.size() > (peer.sendOffset > 0 ? 1u : 0u)) {
+            size_t victim = peer.sendOffset > 0 ? 1 : 0;
+            peer.queuedBytes -= wireSize(peer.queue[victim], peer.v2);
+            peer.queue.erase(peer.queue.begin() + victim);
+            _droppedFrames++;
+        }
+        peer.queue.push_back(frame); // refcount bump, no copy
+        peer.queuedBytes += wireSize(frame, peer.v2);
 
-    TCP(const QHostAddress& addr, int port) {
-        connect(&_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
-        _server.listen(addr, port);
+        tryFlush(peer);
 
-        t = new std::thread(&TCP::checkConnection, this);
-        t->detach();
+        if (peer.dead) {
+            close(peer.fd);
+            it = _peers.erase(it);
+            if (_peers.empty()) {
+                connection = false;
+                notifyConnectionStatusChanged();
+            }
+        } else {
+            queuedTotal += peer.queuedBytes;
+            ++it;
+        }
     }
+    _queuedBytes = queuedTotal;
+}
+
+// Non-blocking drain of one peer's queue; stops on EAGAIN (kernel buffer
+// full) and marks the peer dead on a real error. The framing and the shared
+// payload go out as one scatter-gather write - the framed packet is never
+// assembled in user space.
+void TCP::tryFlush(Peer& peer) {
+    static const char startTag[] = "<bsr>";
+    static const char endTag[] = "</bsr>";
+
+    while (!peer.queue.empty()) {
+        const Frame& front = *peer.queue.front();
+        // queuedBytes is accounted at the uncompressed wire size on push, so
+        // the pop below must subtract the same figure even when the frame
+        // actually left the box smaller
+        const size_t accounted = wireSize(peer.queue.front(), peer.v2);
+        size_t total = accounted;
+
+        // framing is rebuilt on every attempt, but it is a pure function of
+        // the frame, so a partial-write resume sees identical bytes
+        uint8_t header[FrameCodec::HEADER_BYTES];
+        struct { const void* base; size_t len; } segs[3];
+        int segCount;
+        if (peer.v2) {
+            const uint8_t* body = front.data.data();
+            size_t bodyLen = front.data.size();
+            bool compressed = false;
+            if (peer.z) {
+                // compress once when the frame reaches the front; a partial
+                // write resumes from the same zbuf bytes. zlen 0 means the
+                // frame didn't shrink and goes out raw.
+                if (peer.sendOffset == 0) {
+                    peer.zlen = FrameCodec::compressPayload(front.data.data(),
+                                                            front.data.size(), peer.zbuf);
+                }
+                if (peer.zlen != 0) {
+                    body = peer.zbuf.data();
+                    bodyLen = peer.zlen;
+                    compressed = true;
+                }
+            }
+            FrameCodec::writeHeader(header, (uint32_t)bodyLen,
+                                    DataFormat::layoutHash(),
+                                    FrameCodec::checksum(body, bodyLen), compressed);
+            segs[0] = {header, sizeof(header)};
+            segs[1] = {body, bodyLen};
+            segCount = 2;
+            total = FrameCodec::HEADER_BYTES + bodyLen;
+        } else {
+            segs[0] = {startTag, 5};
+            segs[1] = {front.data.data(), front.data.size()};
+            segs[2] = {endTag, 6};
+            segCount = 3;
+        }
+
+        // skip past whatever a previous partial write already covered
+        iovec iov[3];
+        int iovCount = 0;
+        size_t skip = peer.sendOffset;
+        for (int s = 0; s < segCount; s++) {
+            auto& seg = segs[s];
+            if (skip >= seg.len) {
+                skip -= seg.len;
+            } else {
+                iov[iovCount++] = {(void*)((const uint8_t*)seg.base + skip), seg.len - skip};
+                skip = 0;
+            }
+        }
 
-    ~TCP() {
-        finish = true;
-        t->join();
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovCount;
+        ssize_t n = ::sendmsg(peer.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                peer.dead = true;
+            }
+            return;
+        }
+        peer.sendOffset += (size_t)n;
+        if (peer.sendOffset < total) {
+            return; // kernel took a partial write; try again next frame
+        }
+        peer.queuedBytes -= accounted;
+        peer.queue.pop_front();
+        peer.sendOffset = 0;
     }
+}
 
-    void connectSocket(QTcpSocket* clientSocket) {
-        connect(clientSocket, SIGNAL(stateChanged(QAbstractSocket::SocketState)), this, SLOT(onSocketStateChanged(QAbstractSocket::SocketState)));
+void TCP::acceptLoop() {
+    while (!finish) {
+        pollfd p{_server, POLLIN, 0};
+        if (::poll(&p, 1, 500) > 0 && (p.revents & POLLIN)) {
+            onNewConnection();
+        }
     }
-public slots:
-    /*
-     * The onNewConnection slot is triggered when a new connection is established. It accepts the connection, connects
-     * the stateChanged signal of the new socket to the onSocketStateChanged slot of the TCP object, adds the socket to
-     * the list of connected sockets, sets the connection status to true and emits the connectionStatusChanged signal.
-     */
-    void onNewConnection() override{
-        QTcpSocket *clientSocket = _server.nextPendingConnection();
-        connect(clientSocket, SIGNAL(stateChanged(QAbstractSocket::SocketState)), this, SLOT(onSocketStateChanged(QAbstractSocket::SocketState)));
-        _sockets.push_back(clientSocket);
-        connection = true;
-        emit connectionStatusChanged();
-    };
+}
+
+void TCP::onNewConnection() {
+    int clientSocket = ::accept(_server, nullptr, nullptr);
+    if (clientSocket >= 0) {
+        // all peer writes are non-blocking; backpressure is handled by the
+        // per-peer queue, not by stalling in send()
+        fcntl(clientSocket, F_SETFL, O_NONBLOCK);
 
-    /*
-     * The onSocketStateChanged slot is triggered when the state of a connected socket changes. If the state is
-     * QAbstractSocket::UnconnectedState, it removes the socket from the list of connected sockets, sets the connection
-     * status to false and emits the connectionStatusChanged signal.
-     */
-    void onSocketStateChanged(QAbstractSocket::SocketState state) override{
-        if (state == QAbstractSocket::UnconnectedState)
-        {
-            QTcpSocket* sender = static_cast<QTcpSocket*>(QObject::sender());
-            _sockets.removeOne(sender);
-            connection = false;
-            emit connectionStatusChanged();
+        // lead the stream with our format identity so the dashboard can
+        // refuse to decode frames from a build it doesn't match; a receiver
+        // that only scans for <bsr> tags skips this untouched
+        uint8_t fmtMsg[5 + sizeof(uint32_t) + 6];
+        uint32_t hash = DataFormat::layoutHash();
+        memcpy(fmtMsg, "<fmt>", 5);
+        memcpy(fmtMsg + 5, &hash, sizeof(hash));
+        memcpy(fmtMsg + 9, "</fmt>", 6);
+        ::send(clientSocket, fmtMsg, sizeof(fmtMsg), MSG_NOSIGNAL);
+
+        // framing negotiation: a v2-capable dashboard answers the
+        // announcement with the record magic; silence (an old dashboard that
+        // never writes anything) keeps the legacy tag framing. This runs on
+        // the accept thread, so the brief wait stalls nobody.
+        bool v2 = false;
+        bool z = false;
+        pollfd p{clientSocket, POLLIN, 0};
+        if (::poll(&p, 1, 200) > 0 && (p.revents & POLLIN)) {
+            uint8_t token[FrameCodec::MAGIC_LEN];
+            ssize_t n = ::recv(clientSocket, token, sizeof(token), MSG_DONTWAIT);
+            if (n == (ssize_t)sizeof(token)) {
+                // "BSR2" asks for v2 records, "BSRZ" for v2 with compressed
+                // payloads; the receiver opts in, so no config needed here
+                v2 = memcmp(token, FrameCodec::MAGIC, sizeof(token)) == 0;
+                z = memcmp(token, FrameCodec::TOKEN_COMPRESSED, sizeof(token)) == 0;
+                v2 = v2 || z;
+            }
         }
+
+        std::lock_guard<std::mutex> lock(_socketsMutex);
+        _peers.push_back(Peer{clientSocket});
+        _peers.back().v2 = v2;
+        _peers.back().z = z;
+        connection = true;
+        notifyConnectionStatusChanged();
     }
-private:
-    QTcpServer _server;
-    QList<QTcpSocket*> _sockets;
-    std::atomic<bool> connection = false; // This is used when getConnectionStatus() is called
-    std::thread *t;
-    std::atomic<bool> finish = false; // For soft quiting the thread
-
-    /**
-     * Creates a thread that pings the engineering server's static IP to check connection
-     */
-    void checkConnection() {
-        QTcpSocket sock;
-        while (!finish) {
-            sock.connectToHost(Config::getInstance().getConfig()["tcp_server_ip"].toString(), 
-                               Config::getInstance().getConfig()["tcp_port"].toInt());
-
-            bool connected = sock.waitForConnected(4000);
-            if (connected) {
-                sock.close();
-                if (!connection) {
-                    connection = true;
-                    emit connectionStatusChanged();
+}
+
+/**
+ * Watches the engineering server with one persistent non-blocking socket.
+ * While the link is up, kernel TCP keepalives probe it on a timer and a
+ * poll() on the socket reports loss the moment it happens - no more opening
+ * and tearing down a probe connection every 50 ms just to answer a boolean.
+ */
+void TCP::checkConnection() {
+    const Config::Settings& settings = Config::getInstance().settings();
+    const std::string& serverIp = settings.tcpServerIp;
+    int serverPort = settings.tcpPort;
+
+    int probeFd = -1;
+    auto publish = [this](bool up) {
+        if (connection != up) {
+            connection = up;
+            notifyConnectionStatusChanged();
+        }
+    };
+
+    while (!finish) {
+        if (probeFd < 0) {
+            // (re)establish the monitor connection, non-blocking
+            probeFd = ::socket(AF_INET, SOCK_STREAM, 0);
+            fcntl(probeFd, F_SETFL, O_NONBLOCK);
+
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(serverPort);
+            inet_pton(AF_INET, serverIp.c_str(), &addr.sin_addr);
+            ::connect(probeFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+            // up to 4 s for the handshake, in slices so shutdown stays quick
+            bool up = false;
+            for (int waited = 0; !finish && waited < 4000; waited += 500) {
+                pollfd p{probeFd, POLLOUT, 0};
+                if (::poll(&p, 1, 500) > 0) {
+                    int err = 0;
+                    socklen_t len = sizeof(err);
+                    getsockopt(probeFd, SOL_SOCKET, SO_ERROR, &err, &len);
+                    up = (err == 0);
+                    break;
                 }
-            } else {
-                sock.abort();
-                if (connection) {
-                    connection = false;
-                    emit connectionStatusChanged();
+            }
+
+            if (!up) {
+                close(probeFd);
+                probeFd = -1;
+                publish(false);
+                // back off before the next attempt instead of SYN-flooding
+                for (int waited = 0; !finish && waited < 1000; waited += 100) {
+                    usleep(100000);
+                }
+                continue;
+            }
+
+            // let the kernel probe the idle link on a timer
+            int on = 1, idle = 5, interval = 2, count = 2;
+            setsockopt(probeFd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+            setsockopt(probeFd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+            setsockopt(probeFd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+            setsockopt(probeFd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+            publish(true);
+        } else {
+            // connected: sleep in poll() until the socket reports trouble
+            pollfd p{probeFd, POLLIN, 0};
+            if (::poll(&p, 1, 500) > 0) {
+                char c;
+                ssize_t n = ::recv(probeFd, &c, 1, MSG_DONTWAIT);
+                if ((p.revents & (POLLERR | POLLHUP)) ||
+                    n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    close(probeFd);
+                    probeFd = -1;
+                    publish(false);
                 }
             }
-            usleep(50000);
         }
     }
-};
 
+    if (probeFd >= 0) {
+        close(probeFd);
+    }
+}
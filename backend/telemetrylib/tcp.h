@@ -0,0 +1,89 @@
+//
+// Created by Mingcan Li on 1/22/23.
+//
+
+#ifndef TELEMETRYLIB_TCP_H
+#define TELEMETRYLIB_TCP_H
+
+#include "DTI.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TCP : public DTI {
+public:
+    TCP(const std::string& addr, int port);
+    ~TCP();
+
+    void sendData(const FramePtr& frame) override;
+
+    const char* name() const override { return "TCP"; }
+
+    bool getConnectionStatus() {
+        return connection;
+    }
+
+    /*
+     * Accepts new connections on the server socket, adds them to the list of
+     * connected sockets, sets the connection status to true and notifies the
+     * connection status callback.
+     */
+    void onNewConnection() override;
+
+    // Frames dropped / bytes currently queued across all peers
+    uint64_t droppedFrames() const { return _droppedFrames; }
+    uint64_t queuedBytes() const { return _queuedBytes; }
+
+private:
+    /**
+     * One connected dashboard. Writes are non-blocking with a bounded
+     * per-peer coalescing queue: a peer that falls behind loses its own
+     * oldest frames, it never stalls the pipeline or the other peers.
+     * Queued frames are shared FramePtrs; the framing (v2 header or legacy
+     * <bsr> tags, negotiated at connect) is supplied by scatter-gather at
+     * send time, so queueing a frame for N peers costs N refcount bumps, not
+     * N packet copies.
+     */
+    struct Peer {
+        int fd;
+        std::deque<FramePtr> queue; // pending frames
+        size_t queuedBytes = 0;     // framed wire size of everything queued
+        size_t sendOffset = 0;      // wire bytes of queue.front() already sent
+        bool dead = false;
+        bool v2 = false;            // peer answered the announcement with the v2 magic
+        bool z = false;             // peer asked for compressed payloads ("BSRZ" token)
+        std::vector<uint8_t> zbuf;  // compressed front frame, stable across partial writes
+        size_t zlen = 0;            // bytes in zbuf; 0 = front frame going out raw
+    };
+
+    // Flush as much of the peer's queue as the socket accepts right now
+    void tryFlush(Peer& peer);
+
+    // Queue depth per peer before drop-oldest kicks in
+    static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024;
+
+    int _server = -1;
+    std::vector<Peer> _peers;
+    std::mutex _socketsMutex;
+    std::atomic<uint64_t> _droppedFrames = 0;
+    std::atomic<uint64_t> _queuedBytes = 0;
+    std::atomic<bool> connection = false; // This is used when getConnectionStatus() is called
+    std::thread acceptThread;
+    std::thread checkThread;
+    std::atomic<bool> finish = false; // For soft quiting the threads
+
+    // Accept-loop body run by acceptThread
+    void acceptLoop();
+
+    /**
+     * Health monitor for the engineering server: one persistent socket with
+     * kernel keepalives instead of a fresh probe connection every 50 ms
+     */
+    void checkConnection();
+};
+
+#endif //TELEMETRYLIB_TCP_H
@@ -3,6 +3,9 @@
 // Commented by ChatGPT
 //
 #include "telemetry.h"
+#include "backend/metrics.h"
+
+#include <algorithm>
 
 // Default constructor
 Telemetry::Telemetry() {}
@@ -11,14 +14,160 @@ Telemetry::Telemetry() {}
 Telemetry::Telemetry(std::vector<DTI *> commChannels) {
     comm = commChannels;
     // Output the number of initialized communication channels to console
-    qDebug() << "comm channels initialized: " << comm.size();
+    std::cout << "comm channels initialized: " << comm.size() << std::endl;
+
+    running = true;
+    for (DTI* dti : comm) {
+        auto channel = std::make_unique<Channel>();
+        channel->dti = dti;
+        channel->sendLatency = &LatencyStats::getInstance().stage(
+            std::string("ingress_to_") + dti->name() + "_send");
+        channel->heartbeat = &PipelineWatchdog::getInstance().stage(dti->name());
+        if (dti->rateControlled()) {
+            // start optimistic; the AIMD loop walks the rate down to what
+            // the link actually sustains
+            channel->admitHz = MAX_ADMIT_HZ;
+            channel->tokens = ADMIT_BUCKET_DEPTH;
+            channel->lastRefillNs = LatencyStats::nowNs();
+            channel->lastAdjustNs = channel->lastRefillNs;
+        }
+        // scrape-time samplers: depth and drop totals are read under the
+        // channel lock on the scraper's thread, never on the frame path
+        Channel* ch = channel.get();
+        std::string label = "{channel=\"" + std::string(dti->name()) + "\"}";
+        MetricsRegistry::getInstance().sampler("telemetry_queue_depth" + label, false, [ch]() {
+            std::lock_guard<std::mutex> lock(ch->m);
+            return (int64_t)ch->queue.size();
+        });
+        MetricsRegistry::getInstance().sampler("telemetry_dropped_total" + label, true, [ch]() {
+            std::lock_guard<std::mutex> lock(ch->m);
+            return (int64_t)(ch->dropped + ch->admissionDropped);
+        });
+        channel->worker = std::thread(&Telemetry::channelLoop, this, channel.get());
+        channels.push_back(std::move(channel));
+    }
+}
+
+Telemetry::~Telemetry() {
+    running = false;
+    for (auto& channel : channels) {
+        // notify while holding the channel lock: a worker between its
+        // predicate check (which still saw running) and its block would
+        // otherwise miss the wake and hang the join below forever
+        std::lock_guard<std::mutex> lock(channel->m);
+        channel->cv.notify_all();
+    }
+    for (auto& channel : channels) {
+        if (channel->worker.joinable()) {
+            channel->worker.join();
+        }
+    }
+}
+
+// Enqueue data onto all communication channels; never blocks on a send
+void Telemetry::sendData(const FramePtr& frame, uint64_t ingressNs, uint64_t walSeq) {
+    for (auto& channel : channels) {
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(channel->m);
+            // token-bucket admission: a rate-controlled channel takes frames
+            // at its admitted rate and decimates the rest at the door, so a
+            // degraded link ships a steady thinned stream instead of queueing
+            // full rate into a timeout
+            if (channel->admitHz > 0) {
+                uint64_t now = LatencyStats::nowNs();
+                channel->tokens = std::min(ADMIT_BUCKET_DEPTH,
+                    channel->tokens + (double)(now - channel->lastRefillNs) * channel->admitHz / 1e9);
+                channel->lastRefillNs = now;
+                if (channel->tokens < 1.0) {
+                    channel->admissionDropped++;
+                    continue;
+                }
+                channel->tokens -= 1.0;
+            }
+            // bounded queue with drop-oldest; depth is the channel's policy
+            if (channel->queue.size() >= channel->dti->queueCapacity()) {
+                channel->queue.pop_front();
+                channel->dropped++;
+            }
+            wasEmpty = channel->queue.empty();
+            channel->queue.push_back({frame, ingressNs, walSeq});
+        }
+        // only the empty->non-empty transition can have a sleeping worker;
+        // a worker mid-send rechecks the queue before it waits, so skipping
+        // the wake here saves a futex syscall per frame per channel
+        if (wasEmpty) {
+            channel->cv.notify_one();
+        }
+    }
+}
+
+uint64_t Telemetry::ackedWalSeq() const {
+    uint64_t acked = UINT64_MAX;
+    for (const auto& channel : channels) {
+        if (channel->dti->durable()) {
+            acked = std::min(acked, channel->ackedSeq.load(std::memory_order_relaxed));
+        }
+    }
+    return acked;
 }
 
-// Broadcast data to all communication channels 
-void Telemetry::sendData(QByteArray bytes, long long timestamp) {
-    // Loop through all communication channels
-    for (int i = 0; i < comm.size(); i++) {
-        // Send data to the current communication channel
-        comm[i]->sendData(bytes, timestamp);
+void Telemetry::channelLoop(Channel* channel) {
+    while (running) {
+        QueuedFrame item;
+        {
+            std::unique_lock<std::mutex> lock(channel->m);
+            channel->cv.wait(lock, [&] { return !channel->queue.empty() || !running; });
+            if (!running) {
+                return;
+            }
+            item = std::move(channel->queue.front());
+            channel->queue.pop_front();
+        }
+        // the actual send runs here, on this channel's own thread
+        uint64_t sendStart = LatencyStats::nowNs();
+        channel->dti->sendData(item.frame);
+        uint64_t sendNs = LatencyStats::nowNs() - sendStart;
+        channel->heartbeat->beat();
+
+        // AIMD rate adaptation: back off multiplicatively when the queue is
+        // filling or the measured send cost can't sustain the admitted rate,
+        // creep back up additively while the channel is keeping up
+        if (channel->dti->rateControlled()) {
+            channel->ewmaSendNs = channel->ewmaSendNs == 0
+                ? (double)sendNs
+                : channel->ewmaSendNs * 0.9 + (double)sendNs * 0.1;
+            if (sendStart - channel->lastAdjustNs >= 1000000000ull) {
+                std::lock_guard<std::mutex> lock(channel->m);
+                size_t depth = channel->queue.size();
+                bool overloaded = depth > channel->dti->queueCapacity() / 2 ||
+                                  channel->ewmaSendNs * channel->admitHz > 0.5e9;
+                if (overloaded) {
+                    channel->admitHz = std::max(MIN_ADMIT_HZ, channel->admitHz * 0.8);
+                } else if (depth < channel->dti->queueCapacity() / 4) {
+                    channel->admitHz = std::min(MAX_ADMIT_HZ, channel->admitHz + 2.0);
+                }
+                channel->lastAdjustNs = sendStart;
+            }
+        }
+
+        if (item.ingressNs != 0) {
+            channel->sendLatency->record(LatencyStats::nowNs() - item.ingressNs);
+        }
+        // WAL accounting: a frame counts as delivered once the DTI no longer
+        // holds it in an unsent batch. pendingSeqs is in handoff order, so
+        // everything beyond the batch tail has left the process.
+        if (item.walSeq != 0 && channel->dti->durable()) {
+            channel->pendingSeqs.push_back(item.walSeq);
+            size_t unsent = channel->dti->unsentFrames();
+            uint64_t acked = 0;
+            while (channel->pendingSeqs.size() > unsent) {
+                acked = channel->pendingSeqs.front();
+                channel->pendingSeqs.pop_front();
+            }
+            if (acked != 0) {
+                channel->ackedSeq.store(acked, std::memory_order_relaxed);
+            }
+        }
     }
-}
\ No newline at end of file
+}
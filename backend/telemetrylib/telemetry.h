@@ -3,39 +3,65 @@
 
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <atomic>
 #include <functional>
 #include "DTI.h"
+#include "backend/heartbeat.h"
+#include "backend/latencyStats.h"
 
 /**
  * A library built for handling data telemetry that allows automatic switching
  * between communication methods with modular design for future extension
+ *
+ * Each communication channel gets its own bounded queue and worker thread, so
+ * a slow channel (e.g. an SQL upload over a flaky cell link) can never delay
+ * a fast one (UDP to the chase car). When a channel's queue is full the
+ * oldest entry is dropped; each DTI decides its own queue depth via
+ * DTI::queueCapacity(), which is its drop policy.
  */
 class Telemetry {
 public:
     // Callback type for engineering dashboard connection status
     using EngDashConnectionCallback = std::function<void(bool state)>;
-    
+
     Telemetry();
     /**
      * @param comm Data telemetry objects ranked by priority
      */
     Telemetry(std::vector<DTI*> comm);
-    
+    ~Telemetry();
+
+    /**
+     * to send data, as simple as it gets; enqueues onto every channel and
+     * returns immediately. The frame is shared by reference - fan-out to N
+     * channels is N refcount bumps, not N buffer copies.
+     * @param frame immutable frame (bytes + wall timestamp)
+     * @param ingressNs monotonic arrival time of the frame (0 = not tracked);
+     *                  fuels the per-channel send latency histograms
+     * @param walSeq write-ahead log sequence of this frame (0 = not logged);
+     *               durable channels acknowledge it once the frame has left
+     */
+    void sendData(const FramePtr& frame, uint64_t ingressNs = 0, uint64_t walSeq = 0);
+
     /**
-     * to send data, as simple as it gets
-     * @param data telemetry data buffer
-     * @param timestamp the time which the byte array is created
+     * Highest WAL sequence every durable channel has pushed out (frames held
+     * in a channel's unsent batch don't count). UINT64_MAX when no channel is
+     * durable; callers clamp against what they actually logged.
      */
-    void sendData(const std::vector<uint8_t>& data, long long timestamp);
-    
+    uint64_t ackedWalSeq() const;
+
     /**
      * Set callback for engineering dashboard connection status changes
      */
     void setEngDashConnectionCallback(EngDashConnectionCallback callback) {
         engDashConnectionCallback = callback;
     }
-    
+
 protected:
     // Helper method to notify engineering dashboard connection changes
     void notifyEngDashConnection(bool state) {
@@ -45,11 +71,53 @@ protected:
     }
 
 private:
+    // One queued frame reference with its monotonic ingress time
+    struct QueuedFrame {
+        FramePtr frame;
+        uint64_t ingressNs;
+        uint64_t walSeq;
+    };
+
+    // One send queue + worker per channel
+    struct Channel {
+        DTI* dti;
+        std::deque<QueuedFrame> queue;
+        std::mutex m;
+        std::condition_variable cv;
+        uint64_t dropped = 0;
+        LatencyHistogram* sendLatency = nullptr; // ingress -> send completed
+        Heartbeat* heartbeat = nullptr;          // one beat per frame sent
+        // WAL bookkeeping (worker thread only, except the atomic): sequences
+        // handed to the DTI whose frames it may still hold unsent
+        std::deque<uint64_t> pendingSeqs;
+        std::atomic<uint64_t> ackedSeq = 0; // highest sequence fully sent
+        // Adaptive admission (rate-controlled channels; all under m except
+        // ewmaSendNs, which only the worker touches): token bucket at
+        // admitHz with AIMD adjustment against queue depth and send cost
+        double admitHz = 0; // 0 = uncontrolled, every frame admitted
+        double tokens = 0;
+        uint64_t lastRefillNs = 0;
+        uint64_t lastAdjustNs = 0;
+        uint64_t admissionDropped = 0;
+        double ewmaSendNs = 0; // smoothed cost of one dti->sendData call
+        std::thread worker;
+    };
+
+    // Admission rate bounds for rate-controlled channels (frames/sec)
+    static constexpr double MIN_ADMIT_HZ = 1.0;
+    static constexpr double MAX_ADMIT_HZ = 100.0;
+    static constexpr double ADMIT_BUCKET_DEPTH = 5.0; // burst tolerance, frames
+
+    // Worker body: drains one channel's queue
+    void channelLoop(Channel* channel);
+
     int originalSize = 0;
     int compressedSize = 0;
     std::vector<std::vector<uint8_t>> dataCache;
     std::atomic<int> commChannel = -1;
+    std::atomic<bool> running = false;
     std::vector<DTI*> comm;
+    std::vector<std::unique_ptr<Channel>> channels;
     EngDashConnectionCallback engDashConnectionCallback;
 };
 #endif //TELEMETRYLIB_LIBRARY_H
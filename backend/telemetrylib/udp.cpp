@@ -2,44 +2,213 @@
 // Created by Mingcan Li on 1/30/24.
 //
 
-#include "DTI.h"
-
-class UDP : public DTI {
-public:
-    UDP(const QHostAddress& serverAddress, int serverPort) {
-        //_udpSocket.bind(localAddress, localPort);
-        this->serverAddresses = serverAddress;
-        this->udpPort = serverPort;
-        _udpSocket = new QUdpSocket();
-        emit connectionStatusChanged();
-    }
-
-    ~UDP() {
-        // Cleanup and closing of the UDP socket can be added here if needed.
-    }
-
-    void sendData(QByteArray bytes, long long timestamp) override {
-        qDebug() << "sending via UDP";
-        bytes.prepend("<bsr>");
-        bytes.append("</bsr>");
-        _udpSocket->writeDatagram(bytes, serverAddresses, udpPort);
-    }
-    
-public slots:
-    void onReadyRead() {
-        while (_udpSocket->hasPendingDatagrams()) {
-            QByteArray datagram;
-            datagram.resize(_udpSocket->pendingDatagramSize());
-            QHostAddress senderAddress;
-            quint16 senderPort;
-            _udpSocket->readDatagram(datagram.data(), datagram.size(), &senderAddress, &senderPort);
-            // Process the received datagram as needed
+#include "udp.h"
+#include "Config.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameCodec.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Delta-mode packet layout (all integers little-endian):
+//   'B' 'D'          magic
+//   uint8  kind      'K' keyframe / 'D' delta
+//   uint32 hash      DataFormat::layoutHash(), so the receiver can verify it
+//                    was built from the same format.json
+//   uint16 sequence  wraps; lets the receiver spot a missed keyframe
+// keyframe payload: the full frame
+// delta payload:    uint16 count, then per change uint16 field index followed
+//                   by that field's bytes (width from the format layout)
+static constexpr size_t DELTA_HEADER_SIZE = 9;
+
+static void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back((uint8_t)(v & 0xFF));
+    out.push_back((uint8_t)(v >> 8));
+}
+
+UDP::UDP(const std::string& addr, int serverPort) {
+    this->udpPort = serverPort;
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(serverPort);
+    inet_pton(AF_INET, addr.c_str(), &serverAddress.sin_addr);
+    _udpSocket = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+    const Config::Settings& settings = Config::getInstance().settings();
+    framingV2 = settings.udpFramingV2;
+    compress = settings.frameCompression;
+    deltaMode = settings.udpDeltaMode;
+    keyframeInterval = settings.udpKeyframeInterval;
+    applyMulticast(settings);
+
+    // preallocate so steady-state sends never touch the allocator
+    prevFrame.reserve(DataFormat::FRAME_SIZE);
+    scratch.reserve(DataFormat::FRAME_SIZE + DELTA_HEADER_SIZE);
+
+    // follow config hot-reloads: the chase car's address changes when it
+    // hops networks, and a restart to pick that up costs 30+ s of telemetry
+    Config::getInstance().onChange([this](const Config::Settings& s) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        udpPort = s.udpChasecarPort;
+        serverAddress.sin_port = htons((uint16_t)s.udpChasecarPort);
+        inet_pton(AF_INET, s.udpChasecarIp.c_str(), &serverAddress.sin_addr);
+        framingV2 = s.udpFramingV2;
+        compress = s.frameCompression;
+        deltaMode = s.udpDeltaMode;
+        keyframeInterval = s.udpKeyframeInterval;
+        applyMulticast(s);
+        // the new receiver has no delta state for us; resync with a keyframe
+        packetsSinceKeyframe = keyframeInterval;
+    });
+
+    notifyConnectionStatusChanged();
+}
+
+UDP::~UDP() {
+    if (_udpSocket >= 0) {
+        close(_udpSocket);
+    }
+}
+
+// Multicast publishing: one send reaches every listener on the convoy
+// network (both chase cars plus the pit station), so send-side cost stays
+// constant as consumers are added. An empty group keeps plain unicast for
+// the cellular relay case.
+void UDP::applyMulticast(const Config::Settings& settings) {
+    if (settings.udpMulticastGroup.empty()) {
+        return;
+    }
+    in_addr group{};
+    if (inet_pton(AF_INET, settings.udpMulticastGroup.c_str(), &group) != 1 ||
+        !IN_MULTICAST(ntohl(group.s_addr))) {
+        std::cerr << "UDP: udp_multicast_group '" << settings.udpMulticastGroup
+                  << "' is not a multicast address, staying unicast" << std::endl;
+        return;
+    }
+    serverAddress.sin_addr = group;
+
+    // TTL bounds how far past the convoy LAN the datagrams can leak
+    unsigned char ttl = (unsigned char)settings.udpMulticastTtl;
+    setsockopt(_udpSocket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    // pin egress when the box has both the convoy LAN and the cellular
+    // modem up; the kernel's default route would pick for us otherwise
+    if (!settings.udpMulticastInterface.empty()) {
+        in_addr iface{};
+        if (inet_pton(AF_INET, settings.udpMulticastInterface.c_str(), &iface) == 1) {
+            setsockopt(_udpSocket, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+        } else {
+            std::cerr << "UDP: udp_multicast_interface '" << settings.udpMulticastInterface
+                      << "' is not an IPv4 address, using the default route" << std::endl;
         }
     }
+}
+
+void UDP::sendData(const FramePtr& frame) {
+    // taken per frame, contended only for the instant a reload lands
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    // delta mode only makes sense for frames matching the generated layout
+    if (deltaMode && frame->data.size() == (size_t)DataFormat::FRAME_SIZE) {
+        sendDelta(frame->data);
+    } else {
+        sendFullFrame(frame->data);
+    }
+}
+
+void UDP::sendFullFrame(const std::vector<uint8_t>& bytes) {
+    // scatter-gather: framing and payload are never merged in user space
+    if (framingV2) {
+        const uint8_t* body = bytes.data();
+        size_t bodyLen = bytes.size();
+        bool compressed = false;
+        if (compress) {
+            size_t n = FrameCodec::compressPayload(bytes.data(), bytes.size(), zbuf);
+            if (n != 0) {
+                body = zbuf.data();
+                bodyLen = n;
+                compressed = true;
+            }
+        }
+        uint8_t header[FrameCodec::HEADER_BYTES];
+        FrameCodec::writeHeader(header, (uint32_t)bodyLen, DataFormat::layoutHash(),
+                                FrameCodec::checksum(body, bodyLen), compressed);
+        iovec iov[2] = {
+            {header, sizeof(header)},
+            {(void*)body, bodyLen},
+        };
+        sendGathered(iov, 2);
+        return;
+    }
+    static const char startTag[] = "<bsr>";
+    static const char endTag[] = "</bsr>";
+    iovec iov[3] = {
+        {(void*)startTag, 5},
+        {(void*)bytes.data(), bytes.size()},
+        {(void*)endTag, 6},
+    };
+    sendGathered(iov, 3);
+}
+
+void UDP::sendDelta(const std::vector<uint8_t>& bytes) {
+    bool keyframe = prevFrame.size() != bytes.size()
+                 || packetsSinceKeyframe >= keyframeInterval;
+
+    if (!keyframe) {
+        // delta body only; the header travels as its own iovec
+        scratch.clear();
+        putU16(scratch, 0);
+        uint16_t changed = 0;
+        for (int i = 0; i < DataFormat::FIELD_COUNT; i++) {
+            const DataFormat::FieldInfo& f = DataFormat::FIELDS[i];
+            if (std::memcmp(bytes.data() + f.offset, prevFrame.data() + f.offset, f.width) != 0) {
+                putU16(scratch, (uint16_t)i);
+                scratch.insert(scratch.end(), bytes.begin() + f.offset,
+                               bytes.begin() + f.offset + f.width);
+                changed++;
+            }
+        }
+        scratch[0] = (uint8_t)(changed & 0xFF);
+        scratch[1] = (uint8_t)(changed >> 8);
+
+        // a delta bigger than the frame defeats the point - promote it
+        if (scratch.size() >= bytes.size()) {
+            keyframe = true;
+        }
+    }
+
+    uint8_t header[DELTA_HEADER_SIZE];
+    header[0] = 'B';
+    header[1] = 'D';
+    header[2] = keyframe ? 'K' : 'D';
+    uint32_t hash = DataFormat::layoutHash();
+    header[3] = (uint8_t)(hash & 0xFF);
+    header[4] = (uint8_t)((hash >> 8) & 0xFF);
+    header[5] = (uint8_t)((hash >> 16) & 0xFF);
+    header[6] = (uint8_t)((hash >> 24) & 0xFF);
+    header[7] = (uint8_t)(sequence & 0xFF);
+    header[8] = (uint8_t)(sequence >> 8);
+    sequence++;
+
+    iovec iov[2] = {{header, DELTA_HEADER_SIZE}, {}};
+    if (keyframe) {
+        iov[1] = {(void*)bytes.data(), bytes.size()};
+        packetsSinceKeyframe = 0;
+    } else {
+        iov[1] = {scratch.data(), scratch.size()};
+        packetsSinceKeyframe++;
+    }
+
+    prevFrame = bytes; // capacity is reserved, so this is a plain copy
+    sendGathered(iov, 2);
+}
 
-private:
-    QUdpSocket* _udpSocket;
-    QHostAddress serverAddresses;
-    int udpPort;
-    std::atomic<bool> connection = true;
-};
\ No newline at end of file
+void UDP::sendGathered(const iovec* iov, int iovCount) {
+    msghdr msg{};
+    msg.msg_name = &serverAddress;
+    msg.msg_namelen = sizeof(serverAddress);
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = (size_t)iovCount;
+    ::sendmsg(_udpSocket, &msg, 0);
+}
@@ -0,0 +1,65 @@
+//
+// Created by Mingcan Li on 1/30/24.
+//
+
+#ifndef TELEMETRYLIB_UDP_H
+#define TELEMETRYLIB_UDP_H
+
+#include "Config.h"
+#include "DTI.h"
+#include <atomic>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+
+class UDP : public DTI {
+public:
+    UDP(const std::string& serverAddress, int serverPort);
+    ~UDP();
+
+    void sendData(const FramePtr& frame) override;
+
+    // the chase car wants freshness, not history
+    size_t queueCapacity() const override { return 2; }
+
+    const char* name() const override { return "UDP"; }
+
+private:
+    // Full-frame datagram: v2 framed or wrapped in legacy <bsr> tags
+    void sendFullFrame(const std::vector<uint8_t>& bytes);
+    // Delta mode: keyframes plus changed-fields-only packets
+    void sendDelta(const std::vector<uint8_t>& bytes);
+    // One sendmsg over the pieces; the kernel gathers them, we never do
+    void sendGathered(const struct iovec* iov, int iovCount);
+    // Point the destination at the multicast group (and set TTL/egress
+    // interface) when one is configured; leaves unicast alone otherwise
+    void applyMulticast(const Config::Settings& settings);
+
+    int _udpSocket = -1;
+    sockaddr_in serverAddress{};
+    int udpPort;
+    std::atomic<bool> connection = true;
+
+    // guards the destination address and mode flags against the config
+    // reload callback; sends hold it for one frame, reloads are rare
+    std::mutex settingsMutex;
+
+    // full-frame framing: datagrams are self-delineating, so the v2 header
+    // buys the checksum and layout hash. UDP has no in-band negotiation, so
+    // the config flag stands in for it - off until every receiver upgrades.
+    bool framingV2;
+    // deflate v2 payloads (config-gated, same no-negotiation reasoning);
+    // ~4x fewer bytes on the chase-car link for run-heavy frames
+    bool compress;
+    std::vector<uint8_t> zbuf; // compression workspace, reused per send
+
+    // delta mode state
+    bool deltaMode;
+    int keyframeInterval;      // force a full keyframe every N packets
+    int packetsSinceKeyframe = 0;
+    uint16_t sequence = 0;
+    std::vector<uint8_t> prevFrame; // last frame sent, for diffing
+    std::vector<uint8_t> scratch;   // packet under construction
+};
+
+#endif //TELEMETRYLIB_UDP_H
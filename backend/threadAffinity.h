@@ -0,0 +1,51 @@
+#ifndef THREADAFFINITY_H
+#define THREADAFFINITY_H
+
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * Apply the configured pinning and scheduling policy to the calling thread.
+ *
+ * cpu < 0 leaves affinity alone; rtPriority <= 0 leaves the default
+ * scheduler. With both configured, the stage runs SCHED_FIFO on its own
+ * core, so the ingest path stops trading timeslices with the display
+ * compositor. What was (or wasn't) applied is logged so the boot log
+ * doubles as the pinning map. SCHED_FIFO needs CAP_SYS_NICE; a refusal is
+ * reported but never fatal - the pipeline runs the same, just jittery.
+ */
+inline void applyThreadPolicy(const char* stage, int cpu, int rtPriority) {
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+            std::cout << "thread " << stage << ": pinned to cpu " << cpu << std::endl;
+        } else {
+            std::cout << "thread " << stage << ": could not pin to cpu " << cpu << std::endl;
+        }
+    }
+    if (rtPriority > 0) {
+        sched_param sp{};
+        sp.sched_priority = rtPriority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0) {
+            std::cout << "thread " << stage << ": SCHED_FIFO priority "
+                      << rtPriority << std::endl;
+        } else {
+            std::cout << "thread " << stage << ": SCHED_FIFO refused"
+                      << " (needs CAP_SYS_NICE / root)" << std::endl;
+        }
+    }
+#else
+    (void)stage;
+    (void)cpu;
+    (void)rtPriority;
+#endif
+}
+
+#endif // THREADAFFINITY_H
@@ -0,0 +1,59 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <cstdint>
+#include <ctime>
+
+/**
+ * One timebase for the whole pipeline.
+ *
+ * Every subsystem used to take its own std::chrono::system_clock reading
+ * and redo the hr/mn/sc/ms divisions per frame. These helpers are the
+ * single source of "now": wallMs()/monoNs() are each one vDSO
+ * clock_gettime, and fields() caches the division work per second - at
+ * 50 Hz, 49 of 50 frames reuse the cached hour/minute/second and only
+ * recompute the millisecond remainder. Monotonic time here is the same
+ * clock the latency histograms use, so cross-stage timing lines up by
+ * construction.
+ */
+class Timebase {
+public:
+    // Wall clock, milliseconds since the epoch
+    static long long wallMs() {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    // Monotonic nanoseconds, same source as LatencyStats::nowNs()
+    static uint64_t monoNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    }
+
+    // Wall-clock field breakdown of a wallMs() reading (UTC)
+    struct WallFields {
+        uint8_t hr;
+        uint8_t mn;
+        uint8_t sc;
+        uint16_t ms;
+    };
+
+    static WallFields fields(long long wallMs) {
+        // per-thread cache: the divisions only rerun when the second ticks
+        thread_local long long cachedSec = -1;
+        thread_local WallFields cached{};
+        long long sec = wallMs / 1000;
+        if (sec != cachedSec) {
+            cached.hr = (uint8_t)((sec / 3600) % 24);
+            cached.mn = (uint8_t)((sec / 60) % 60);
+            cached.sc = (uint8_t)(sec % 60);
+            cachedSec = sec;
+        }
+        cached.ms = (uint16_t)(wallMs - sec * 1000);
+        return cached;
+    }
+};
+
+#endif // TIMEBASE_H
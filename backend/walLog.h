@@ -0,0 +1,201 @@
+#ifndef WALLOG_H
+#define WALLOG_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/**
+ * Preallocated memory-mapped write-ahead log for frames in flight to the
+ * telemetry sinks.
+ *
+ * Fixed-size records live in a ring of `capacity` slots behind a one-page
+ * header that persists the write and ack sequence numbers. An append is a
+ * memcpy plus a counter bump; durability comes from group commit - every
+ * syncEveryN appends the dirty record range is msync'd MS_SYNC and then the
+ * header, in that order, so the persisted writeSeq never runs ahead of the
+ * record bytes it points at. A crash costs at most the last few frames
+ * instead of everything a sink still had queued or batched in memory.
+ * Because the kernel may still write pages back in any order, each slot
+ * carries a trailer stamping its sequence and a CRC of the payload; replay
+ * verifies the stamp so a torn tail or a stale lap of a slot is skipped
+ * rather than re-sent as a valid frame. Sequence numbers start at 1 and
+ * never reset; the records in (ackSeq, writeSeq] are the ones a restart
+ * must replay. When the ring laps an unacked record the oldest is
+ * overwritten - the log bounds disk use, not the sinks' debt.
+ */
+class WriteAheadLog {
+public:
+    // layoutHash identifies the frame layout of the writing build; a log
+    // written under a different format.json is started clean rather than
+    // replayed into frames that would decode from wrong offsets
+    WriteAheadLog(const std::string& directory, uint32_t recordBytes,
+                  uint32_t layoutHash = 0, uint32_t capacity = 4096, uint32_t syncEveryN = 8)
+        : recordBytes(recordBytes), capacity(capacity), syncEveryN(syncEveryN) {
+        std::string path = directory + "frames.wal";
+        size_t fileBytes = HEADER_BYTES + (size_t)slotBytes() * capacity;
+
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            return;
+        }
+        if (::ftruncate(fd, (off_t)fileBytes) != 0) {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        void* map = ::mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        base = (uint8_t*)map;
+        mappedBytes = fileBytes;
+        header = (Header*)base;
+
+        // a valid header from a previous run means there may be frames to
+        // replay; anything else (fresh file, layout change) starts clean
+        if (std::memcmp(header->magic, "BWAL", 4) != 0 || header->version != VERSION ||
+            header->recordBytes != recordBytes || header->capacity != capacity ||
+            header->layoutHash != layoutHash || header->ackSeq > header->writeSeq) {
+            std::memcpy(header->magic, "BWAL", 4);
+            header->version = VERSION;
+            header->recordBytes = recordBytes;
+            header->capacity = capacity;
+            header->layoutHash = layoutHash;
+            header->writeSeq = 0;
+            header->ackSeq = 0;
+            ::msync(base, HEADER_BYTES, MS_SYNC);
+        }
+    }
+
+    ~WriteAheadLog() {
+        if (base != nullptr) {
+            ::msync(base, mappedBytes, MS_SYNC);
+            ::munmap(base, mappedBytes);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    bool valid() const { return base != nullptr; }
+
+    // Append one record; returns its sequence number (0 if the log is down)
+    uint64_t append(const uint8_t* data) {
+        if (base == nullptr) {
+            return 0;
+        }
+        uint64_t seq = header->writeSeq + 1;
+        uint8_t* slot = slotPtr(seq);
+        std::memcpy(slot, data, recordBytes);
+        // stamp the slot so replay can tell this lap's bytes from a torn
+        // write or the previous occupant
+        Trailer t{seq, (uint32_t)::crc32(0, data, (uInt)recordBytes)};
+        std::memcpy(slot + recordBytes, &t, sizeof(t));
+        header->writeSeq = seq;
+
+        // group commit: one MS_SYNC per syncEveryN frames, records strictly
+        // before the header - the persisted writeSeq must never point at
+        // slot bytes that didn't make it out
+        size_t off = (size_t)(slot - base);
+        dirtyLow = dirtyLow == 0 ? pageFloor(off) : std::min(dirtyLow, pageFloor(off));
+        dirtyHigh = std::max(dirtyHigh, off + slotBytes());
+        if (++appendsSinceSync >= syncEveryN) {
+            ::msync(base + dirtyLow, dirtyHigh - dirtyLow, MS_SYNC);
+            ::msync(base, HEADER_BYTES, MS_SYNC);
+            appendsSinceSync = 0;
+            dirtyLow = 0;
+            dirtyHigh = 0;
+        }
+        return seq;
+    }
+
+    // Mark everything up to and including seq as delivered. Persisted with
+    // the next group commit; a stale ack after a crash only means a little
+    // extra replay.
+    void ackUpTo(uint64_t seq) {
+        if (base != nullptr && seq > header->ackSeq && seq <= header->writeSeq) {
+            header->ackSeq = seq;
+        }
+    }
+
+    // Replay range after a restart: records in (ackSeq, writeSeq] that the
+    // ring still holds
+    uint64_t firstPending() const {
+        if (base == nullptr) {
+            return 1;
+        }
+        uint64_t oldestHeld = header->writeSeq > capacity ? header->writeSeq - capacity + 1 : 1;
+        return std::max(header->ackSeq + 1, oldestHeld);
+    }
+
+    uint64_t lastWritten() const { return base != nullptr ? header->writeSeq : 0; }
+
+    const uint8_t* record(uint64_t seq) const { return slotPtr(seq); }
+
+    // True iff the slot actually holds record `seq` from this lap, intact:
+    // the stamp survives only if the payload pages made it to disk with it
+    bool verify(uint64_t seq) const {
+        if (base == nullptr) {
+            return false;
+        }
+        Trailer t{};
+        std::memcpy(&t, slotPtr(seq) + recordBytes, sizeof(t));
+        return t.seq == seq &&
+               t.crc == (uint32_t)::crc32(0, slotPtr(seq), (uInt)recordBytes);
+    }
+
+private:
+    static constexpr uint32_t VERSION = 3;
+    static constexpr size_t HEADER_BYTES = 4096;
+    static constexpr size_t PAGE = 4096;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordBytes;
+        uint32_t capacity;
+        uint32_t layoutHash; // DataFormat::layoutHash() of the writing build
+        uint64_t writeSeq; // highest sequence appended
+        uint64_t ackSeq;   // highest sequence confirmed delivered
+    };
+
+    // Per-slot trailer, written with the payload, checked by replay
+    struct Trailer {
+        uint64_t seq;
+        uint32_t crc; // of the payload bytes
+    };
+
+    size_t slotBytes() const { return (size_t)recordBytes + sizeof(Trailer); }
+
+    uint8_t* slotPtr(uint64_t seq) const {
+        return base + HEADER_BYTES + (size_t)((seq - 1) % capacity) * slotBytes();
+    }
+
+    static size_t pageFloor(size_t off) { return off & ~(PAGE - 1); }
+
+    uint32_t recordBytes;
+    uint32_t capacity;
+    uint32_t syncEveryN;
+
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    Header* header = nullptr;
+    uint32_t appendsSinceSync = 0;
+    size_t dirtyLow = 0;
+    size_t dirtyHigh = 0;
+};
+
+#endif // WALLOG_H
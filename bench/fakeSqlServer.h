@@ -0,0 +1,164 @@
+#ifndef FAKESQLSERVER_H
+#define FAKESQLSERVER_H
+
+//
+// Stand-in SQL server shared by the soak harness and the pipeline
+// benchmark. Speaks just enough keep-alive HTTP for sql.cpp: answers
+// /add-table with a table name and counts the frames in every
+// /add-data-batch. Blackholing closes the listener and every connection,
+// so the sink sees exactly what a dead cellular link looks like (connect
+// refused / send failure).
+//
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class FakeSqlServer {
+public:
+    bool start() {
+        listenFd = openListener();
+        if (listenFd < 0) {
+            return false;
+        }
+        running = true;
+        serverThread = std::thread(&FakeSqlServer::loop, this);
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        if (serverThread.joinable()) {
+            serverThread.join();
+        }
+        closeAll();
+    }
+
+    void setBlackhole(bool on) { blackhole = on; }
+    uint64_t framesReceived() const { return frames; }
+
+private:
+    static int openListener() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int opt = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(80);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void closeAll() {
+        for (int fd : clients) {
+            close(fd);
+        }
+        clients.clear();
+        if (listenFd >= 0) {
+            close(listenFd);
+            listenFd = -1;
+        }
+    }
+
+    void loop() {
+        while (running) {
+            if (blackhole) {
+                closeAll(); // refuse everything until the hole is lifted
+                while (running && blackhole) {
+                    usleep(10000);
+                }
+                if (running) {
+                    listenFd = openListener();
+                }
+                continue;
+            }
+
+            std::vector<pollfd> fds;
+            fds.push_back({listenFd, POLLIN, 0});
+            for (int fd : clients) {
+                fds.push_back({fd, POLLIN, 0});
+            }
+            if (::poll(fds.data(), fds.size(), 100) <= 0) {
+                continue;
+            }
+            if (fds[0].revents & POLLIN) {
+                int fd = ::accept(listenFd, nullptr, nullptr);
+                if (fd >= 0) {
+                    clients.push_back(fd);
+                }
+            }
+            for (size_t i = 1; i < fds.size(); i++) {
+                if (fds[i].revents & POLLIN) {
+                    if (!serveOne(fds[i].fd)) {
+                        close(fds[i].fd);
+                        clients.erase(std::find(clients.begin(), clients.end(), fds[i].fd));
+                    }
+                }
+            }
+        }
+        closeAll();
+    }
+
+    // Read one request off the connection and answer it; false on EOF/error
+    bool serveOne(int fd) {
+        std::string request;
+        char buf[4096];
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = 0;
+        while (true) {
+            if (headerEnd == std::string::npos) {
+                headerEnd = request.find("\r\n\r\n");
+                if (headerEnd != std::string::npos) {
+                    size_t at = request.find("Content-Length:");
+                    contentLength = at == std::string::npos
+                        ? 0 : strtoul(request.c_str() + at + 15, nullptr, 10);
+                }
+            }
+            if (headerEnd != std::string::npos &&
+                request.size() >= headerEnd + 4 + contentLength) {
+                break;
+            }
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                return false;
+            }
+            request.append(buf, (size_t)n);
+        }
+
+        std::string body = "{\"response\":\"ok\"}";
+        if (request.find("/add-table/") != std::string::npos) {
+            body = "{\"response\":\"soak\"}";
+        } else {
+            size_t at = request.find("count=");
+            if (at != std::string::npos) {
+                frames += strtoul(request.c_str() + at + 6, nullptr, 10);
+            }
+        }
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\n\r\n" + body;
+        return ::send(fd, response.data(), response.size(), MSG_NOSIGNAL) ==
+               (ssize_t)response.size();
+    }
+
+    int listenFd = -1;
+    std::vector<int> clients;
+    std::thread serverThread;
+    std::atomic<bool> running = false;
+    std::atomic<bool> blackhole = false;
+    std::atomic<uint64_t> frames = 0;
+};
+
+#endif // FAKESQLSERVER_H
@@ -0,0 +1,311 @@
+//
+// Macro regression benchmark: runs the full DataFetcher / BackendProcesses /
+// Telemetry / decode stack headless over a recorded log, replayed through
+// the ethernet framing path as fast as the socket accepts it, and writes a
+// machine-readable report so two builds can be diffed on real race data.
+// Distinct from telemetry_bench, which times single functions in isolation.
+//
+//   pipeline_bench [--log <segment>]... [--frames N] [--out report.prom]
+//
+// Without --log, deterministic synthetic frames stand in (same generator as
+// frame_replay), so the target runs out of the box; point --log at sync-log
+// or history-log segments for the real thing. The report is Prometheus text:
+// bench_* lines (offered/processed rates, wall time, peak RSS, heap
+// allocations during replay) plus the pipeline's own counters, stage beats
+// and latency quantiles. Diff two reports with `diff` or a one-line awk.
+//
+// Like the soak harness, the benchmark runs from a scratch directory with
+// its own config.json and stands in for the SQL server when it can bind
+// port 80 (needs root; without it the SQL channel just retries against
+// nothing, which is noted in the report).
+//
+
+#include "DataProcessor/dataUnpacker.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameCodec.h"
+#include "backend/heartbeat.h"
+#include "backend/latencyStats.h"
+#include "backend/metrics.h"
+#include "bench/fakeSqlServer.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <netinet/in.h>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int INGEST_PORT = 14006;
+
+// ---- allocation counting ---------------------------------------------------
+// Global new/delete overrides local to this binary: every heap allocation in
+// the process bumps a relaxed counter, so the report can show how many the
+// replay phase cost. Steady state should be near zero - the pools and scratch
+// buffers exist so the frame path doesn't allocate.
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(n);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t n) {
+    return operator new(n);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ---- recorded input --------------------------------------------------------
+
+// Wrap a raw frame in the v2 wire framing once, up front
+static std::vector<uint8_t> frameRecord(const uint8_t* data, size_t len) {
+    std::vector<uint8_t> out(FrameCodec::HEADER_BYTES + len);
+    FrameCodec::writeHeader(out.data(), (uint32_t)len, DataFormat::layoutHash(),
+                            FrameCodec::checksum(data, len));
+    memcpy(out.data() + FrameCodec::HEADER_BYTES, data, len);
+    return out;
+}
+
+// Extract payloads from a recorded segment; v2 records (compressed or not)
+// and legacy <bsr>-tagged streams both load, same rules as frame_replay
+static void loadLog(const std::string& path, std::vector<std::vector<uint8_t>>& frames) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> blob((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+
+    if (blob.size() >= FrameCodec::MAGIC_LEN &&
+        memcmp(blob.data(), FrameCodec::MAGIC, FrameCodec::MAGIC_LEN) == 0) {
+        size_t pos = 0;
+        FrameCodec::Header hdr;
+        std::vector<uint8_t> inflated(DataFormat::FRAME_SIZE);
+        while (pos + FrameCodec::HEADER_BYTES <= blob.size() &&
+               FrameCodec::readHeader((const uint8_t*)blob.data() + pos, hdr) &&
+               pos + FrameCodec::HEADER_BYTES + hdr.length <= blob.size()) {
+            const uint8_t* payload = (const uint8_t*)blob.data() + pos + FrameCodec::HEADER_BYTES;
+            if (FrameCodec::checksum(payload, hdr.length) == hdr.crc) {
+                if (hdr.compressed) {
+                    size_t n = FrameCodec::decompressPayload(payload, hdr.length,
+                                                             inflated.data(), inflated.size());
+                    if (n != 0) {
+                        frames.push_back(frameRecord(inflated.data(), n));
+                    }
+                } else {
+                    frames.push_back(frameRecord(payload, hdr.length));
+                }
+            }
+            pos += FrameCodec::HEADER_BYTES + hdr.length;
+        }
+        return;
+    }
+
+    const std::string start = "<bsr>";
+    const std::string end = "</bsr>";
+    size_t pos = 0;
+    while (true) {
+        size_t s = std::string_view(blob.data(), blob.size()).find(start, pos);
+        if (s == std::string_view::npos) {
+            break;
+        }
+        size_t e = std::string_view(blob.data(), blob.size()).find(end, s);
+        if (e == std::string_view::npos) {
+            break;
+        }
+        const uint8_t* payload = (const uint8_t*)blob.data() + s + start.size();
+        frames.push_back(frameRecord(payload, e - s - start.size()));
+        pos = e + end.size();
+    }
+}
+
+static void syntheticFrames(std::vector<std::vector<uint8_t>>& frames) {
+    // a few dozen distinct frames so the dirty-field tracking and delta
+    // paths see changing data, deterministic so two builds replay the same
+    std::mt19937 rng(42);
+    for (int k = 0; k < 64; k++) {
+        std::vector<uint8_t> frame(DataFormat::FRAME_SIZE);
+        for (auto& b : frame) {
+            b = (uint8_t)rng();
+        }
+        for (const auto& f : DataFormat::FIELDS) {
+            if (f.type == DataFormat::FieldType::Bool) {
+                frame[f.offset] &= 1;
+            }
+        }
+        frames.push_back(frameRecord(frame.data(), frame.size()));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> logs;
+    uint64_t targetFrames = 50000;
+    std::string outPath = "pipeline-bench.prom";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--log" && i + 1 < argc) {
+            logs.push_back(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            targetFrames = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--log <segment>]... [--frames N] [--out report.prom]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    // resolve before chdir moves the working directory
+    outPath = std::filesystem::absolute(outPath).string();
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (const std::string& log : logs) {
+        loadLog(log, frames);
+    }
+    if (logs.empty()) {
+        syntheticFrames(frames);
+    }
+    if (frames.empty()) {
+        fprintf(stderr, "no frames to replay (log empty or unreadable)\n");
+        return 1;
+    }
+
+    // scratch directory with a localhost config, clean state every run so
+    // WAL replay / spill catch-up never pollute the measured numbers
+    std::string dir = std::filesystem::temp_directory_path().string() + "/driver-io-bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    for (const char* leftover : {"driver-io-wal", "driver-io-spill", "driver-io-file-sync",
+                                 "driver-io-telemetry-log", "driver-io-column-log",
+                                 "driver-io-blackbox"}) {
+        std::filesystem::remove_all(
+            std::filesystem::temp_directory_path().string() + "/" + leftover);
+    }
+    if (chdir(dir.c_str()) != 0) {
+        fprintf(stderr, "cannot enter %s\n", dir.c_str());
+        return 1;
+    }
+    {
+        FILE* fp = fopen("config.json", "w");
+        fprintf(fp, "{\n"
+                    "  \"sql_server_url\": \"127.0.0.1\",\n"
+                    "  \"sql_transfer_timeout\": 500,\n"
+                    "  \"sql_retry_interval\": 500,\n"
+                    "  \"sql_batch_frames\": 25,\n"
+                    "  \"sql_batch_window_ms\": 250,\n"
+                    "  \"tcp_server_ip\": \"127.0.0.1\",\n"
+                    "  \"udp_chasecar_ip\": \"127.0.0.1\",\n"
+                    "  \"udp_chasecar_port\": 14004,\n"
+                    "  \"EthernetPort\": %d,\n"
+                    "  \"metrics_port\": 0,\n"
+                    "  \"file_sync_scan_interval\": 3600000\n"
+                    "}\n", INGEST_PORT);
+        fclose(fp);
+    }
+
+    FakeSqlServer server;
+    bool haveSql = server.start();
+
+    DataUnpacker unpacker;
+    unpacker.start();
+    usleep(500000); // let the ingest listener come up
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(INGEST_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "cannot connect to ingest port %d\n", INGEST_PORT);
+        return 1;
+    }
+
+    printf("replaying %llu frame(s) (%zu distinct) through the ingest path...\n",
+           (unsigned long long)targetFrames, frames.size());
+
+    // allocation baseline after init: what follows is steady state
+    uint64_t allocsBefore = g_allocations.load(std::memory_order_relaxed);
+    auto t0 = std::chrono::steady_clock::now();
+
+    uint64_t sent = 0;
+    for (size_t index = 0; sent < targetFrames; index = (index + 1) % frames.size()) {
+        const std::vector<uint8_t>& record = frames[index];
+        size_t off = 0;
+        while (off < record.size()) {
+            ssize_t n = ::send(fd, record.data() + off, record.size() - off, MSG_NOSIGNAL);
+            if (n < 0) {
+                fprintf(stderr, "send failed after %llu frames\n", (unsigned long long)sent);
+                return 1;
+            }
+            off += (size_t)n;
+        }
+        sent++;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    usleep(1000000); // let the backend drain what the ring still holds
+    auto tEnd = std::chrono::steady_clock::now();
+
+    uint64_t allocsDuring = g_allocations.load(std::memory_order_relaxed) - allocsBefore;
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    // processed rate over the whole window including the drain; the ring is
+    // drop-oldest, so offered and processed legitimately diverge under blast
+    double totalSeconds = std::chrono::duration<double>(tEnd - t0).count();
+    uint64_t processed = PipelineWatchdog::getInstance().stage("backend").value();
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+    // report: bench_* headline numbers plus everything the pipeline already
+    // counts, in one diffable text rendering
+    std::ostringstream report;
+    report << "# TYPE bench_frames_offered_total counter\n"
+           << "bench_frames_offered_total " << sent << "\n"
+           << "# TYPE bench_frames_processed_total counter\n"
+           << "bench_frames_processed_total " << processed << "\n"
+           << "# TYPE bench_wall_seconds gauge\n"
+           << "bench_wall_seconds " << seconds << "\n"
+           << "# TYPE bench_offered_fps gauge\n"
+           << "bench_offered_fps " << (double)sent / seconds << "\n"
+           << "# TYPE bench_processed_fps gauge\n"
+           << "bench_processed_fps " << (double)processed / totalSeconds << "\n"
+           << "# TYPE bench_peak_rss_kb gauge\n"
+           << "bench_peak_rss_kb " << usage.ru_maxrss << "\n"
+           << "# TYPE bench_allocations_total counter\n"
+           << "bench_allocations_total " << allocsDuring << "\n"
+           << "# TYPE bench_sql_delivery_counted gauge\n"
+           << "bench_sql_delivery_counted " << (haveSql ? 1 : 0) << "\n";
+    MetricsRegistry::getInstance().render(report);
+    PipelineWatchdog::getInstance().exportMetrics(report);
+    LatencyStats::getInstance().exportMetrics(report);
+
+    std::ofstream out(outPath, std::ios::trunc);
+    out << report.str();
+    out.close();
+
+    printf("offered  %10.0f frames/s (%llu frames in %.2f s)\n",
+           (double)sent / seconds, (unsigned long long)sent, seconds);
+    printf("processed %9.0f frames/s (%llu through the backend)\n",
+           (double)processed / totalSeconds, (unsigned long long)processed);
+    printf("peak RSS  %9ld kB, %llu heap allocation(s) during replay\n",
+           usage.ru_maxrss, (unsigned long long)allocsDuring);
+    printf("report written to %s\n", outPath.c_str());
+
+    close(fd);
+    unpacker.stop();
+    server.stop();
+    return 0;
+}
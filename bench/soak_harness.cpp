@@ -0,0 +1,323 @@
+//
+// Fault-injection soak harness: drives the real DataFetcher /
+// BackendProcesses / Telemetry stack in-process while injecting the
+// degradation modes races actually produce - mid-frame TCP disconnects,
+// SQL endpoint blackholes, corrupt and stalled frames - and reports
+// sustained frames/sec, delivery counts and recovery latency per scenario.
+//
+// Build the soak_harness target and run it from anywhere: the harness
+// creates a scratch directory with its own config.json pointing every link
+// at localhost, stands in for the SQL server itself, and feeds the ingest
+// port like frame_replay does. The SQL blackhole scenario needs to bind
+// port 80 (the sink hardcodes it); it is skipped with a note when the bind
+// fails.
+//
+
+#include "DataProcessor/dataUnpacker.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameCodec.h"
+#include "bench/fakeSqlServer.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int INGEST_PORT = 14005;
+static constexpr double SEND_FPS = 100.0;
+
+static long long nowMs() {
+    return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- frame source ----------------------------------------------------------
+// Connects to the ingest port like a vehicle board and streams v2-framed
+// synthetic frames with per-scenario fault injection.
+class FrameSource {
+public:
+    FrameSource() {
+        std::mt19937 rng(42);
+        std::vector<uint8_t> frame(DataFormat::FRAME_SIZE);
+        for (auto& b : frame) {
+            b = (uint8_t)rng();
+        }
+        for (const auto& f : DataFormat::FIELDS) {
+            if (f.type == DataFormat::FieldType::Bool) {
+                frame[f.offset] &= 1;
+            }
+        }
+        record.resize(FrameCodec::HEADER_BYTES + frame.size());
+        FrameCodec::writeHeader(record.data(), (uint32_t)frame.size(),
+                                DataFormat::layoutHash(),
+                                FrameCodec::checksum(frame.data(), frame.size()));
+        memcpy(record.data() + FrameCodec::HEADER_BYTES, frame.data(), frame.size());
+    }
+
+    ~FrameSource() {
+        disconnect();
+    }
+
+    bool connect() {
+        disconnect();
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(INGEST_PORT);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    bool connected() const { return fd >= 0; }
+
+    // One well-formed frame
+    bool sendFrame() {
+        return sendBytes(record.data(), record.size());
+    }
+
+    // First `fraction` of a frame, then nothing (caller disconnects)
+    bool sendPartial(double fraction) {
+        return sendBytes(record.data(), (size_t)(record.size() * fraction));
+    }
+
+    // A frame with a corrupted payload byte (checksum mismatch on receive)
+    bool sendCorrupt() {
+        std::vector<uint8_t> bad = record;
+        bad[FrameCodec::HEADER_BYTES + 7] ^= 0xFF;
+        return sendBytes(bad.data(), bad.size());
+    }
+
+    // A burst of garbage between records (connector noise)
+    bool sendGarbage(size_t n) {
+        std::vector<uint8_t> junk(n, 0x5A);
+        return sendBytes(junk.data(), junk.size());
+    }
+
+    // A frame dribbled out in three chunks with stalls in between
+    bool sendStalled() {
+        size_t third = record.size() / 3;
+        if (!sendBytes(record.data(), third)) return false;
+        usleep(50000);
+        if (!sendBytes(record.data() + third, third)) return false;
+        usleep(50000);
+        return sendBytes(record.data() + 2 * third, record.size() - 2 * third);
+    }
+
+private:
+    bool sendBytes(const uint8_t* data, size_t len) {
+        size_t off = 0;
+        while (off < len) {
+            ssize_t n = ::send(fd, data + off, len - off, MSG_NOSIGNAL);
+            if (n < 0) {
+                return false;
+            }
+            off += (size_t)n;
+        }
+        return true;
+    }
+
+    int fd = -1;
+    std::vector<uint8_t> record;
+};
+
+// ---- scenarios -------------------------------------------------------------
+
+struct ScenarioResult {
+    const char* name;
+    uint64_t sent = 0;
+    uint64_t delivered = 0;
+    double fps = 0;
+    long long recoveryMs = -1; // fault cleared -> next delivery; -1 = n/a
+};
+
+int main() {
+    // scratch directory with a config pointing every link at localhost; must
+    // be in place before anything touches Config
+    std::string dir = std::filesystem::temp_directory_path().string() + "/driver-io-soak";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    // also start the pipeline from clean state, or the WAL replay and spill
+    // catch-up of a previous run pollute this run's delivery counts
+    for (const char* leftover : {"driver-io-wal", "driver-io-spill", "driver-io-file-sync",
+                                 "driver-io-telemetry-log", "driver-io-column-log",
+                                 "driver-io-blackbox"}) {
+        std::filesystem::remove_all(
+            std::filesystem::temp_directory_path().string() + "/" + leftover);
+    }
+    if (chdir(dir.c_str()) != 0) {
+        fprintf(stderr, "cannot enter %s\n", dir.c_str());
+        return 1;
+    }
+    {
+        FILE* fp = fopen("config.json", "w");
+        fprintf(fp, "{\n"
+                    "  \"sql_server_url\": \"127.0.0.1\",\n"
+                    "  \"sql_transfer_timeout\": 500,\n"
+                    "  \"sql_retry_interval\": 500,\n"
+                    "  \"sql_batch_frames\": 25,\n"
+                    "  \"sql_batch_window_ms\": 250,\n"
+                    "  \"tcp_server_ip\": \"127.0.0.1\",\n"
+                    "  \"udp_chasecar_ip\": \"127.0.0.1\",\n"
+                    "  \"udp_chasecar_port\": 14003,\n"
+                    "  \"EthernetPort\": %d,\n"
+                    "  \"file_sync_scan_interval\": 3600000\n"
+                    "}\n", INGEST_PORT);
+        fclose(fp);
+    }
+
+    FakeSqlServer server;
+    bool haveSql = server.start();
+    if (!haveSql) {
+        fprintf(stderr, "note: cannot bind 127.0.0.1:80 (needs root or "
+                        "CAP_NET_BIND_SERVICE); delivery counts and the "
+                        "blackhole scenario are disabled\n");
+    }
+
+    DataUnpacker unpacker;
+    unpacker.start();
+    usleep(500000); // let the ingest listener come up
+
+    FrameSource source;
+    if (!source.connect()) {
+        fprintf(stderr, "cannot connect to ingest port %d\n", INGEST_PORT);
+        return 1;
+    }
+
+    const uint64_t intervalUs = (uint64_t)(1e6 / SEND_FPS);
+    std::vector<ScenarioResult> results;
+
+    // Each scenario streams for ~10 s; `fault(i)` runs instead of the plain
+    // send for frames it wants to mangle and returns the fault's clear time
+    // (0 = no fault this frame). Recovery is measured live: time from the
+    // last fault clearing to the next delivery landing at the sink, which
+    // includes reconnect, batch windows and any spill catch-up.
+    auto runScenario = [&](const char* name, int seconds, auto&& fault) {
+        ScenarioResult r{name};
+        uint64_t deliveredBefore = server.framesReceived();
+        long long start = nowMs();
+        long long faultAt = -1;
+        uint64_t deliveredAtFault = 0;
+        for (uint64_t i = 0; nowMs() - start < seconds * 1000; i++) {
+            if (!source.connected() && !source.connect()) {
+                usleep((useconds_t)intervalUs);
+                continue;
+            }
+            long long clearedAt = fault(i);
+            if (clearedAt > 0) {
+                faultAt = clearedAt;
+                deliveredAtFault = server.framesReceived();
+            } else if (source.sendFrame()) {
+                r.sent++;
+            } else {
+                source.disconnect();
+            }
+            if (faultAt > 0 && nowMs() >= faultAt &&
+                server.framesReceived() > deliveredAtFault) {
+                r.recoveryMs = nowMs() - faultAt;
+                faultAt = -1;
+            }
+            usleep((useconds_t)intervalUs);
+        }
+        // drain the last batch window so delivered counts are honest
+        usleep(600000);
+        r.delivered = server.framesReceived() - deliveredBefore;
+        r.fps = (double)r.sent / seconds;
+        results.push_back(r);
+        printf("%-24s sent %6llu delivered %6llu (%.0f fps offered)%s\n",
+               name, (unsigned long long)r.sent, (unsigned long long)r.delivered, r.fps,
+               r.recoveryMs >= 0
+                   ? (" recovery " + std::to_string(r.recoveryMs) + " ms").c_str() : "");
+    };
+
+    runScenario("baseline", 10, [](uint64_t) -> long long { return 0; });
+
+    runScenario("mid-frame disconnect", 10, [&](uint64_t i) -> long long {
+        if (i % 200 == 199) { // every ~2 s, die halfway through a frame
+            source.sendPartial(0.5);
+            source.disconnect();
+            return nowMs();
+        }
+        return 0;
+    });
+
+    runScenario("corrupt frames", 10, [&](uint64_t i) -> long long {
+        if (i % 10 == 9) { // 10% corrupt, plus the occasional noise burst
+            if (!source.sendCorrupt() || (i % 100 == 99 && !source.sendGarbage(256))) {
+                source.disconnect();
+            }
+            return nowMs();
+        }
+        return 0;
+    });
+
+    runScenario("stalled frames", 10, [&](uint64_t i) -> long long {
+        if (i % 50 == 49) { // dribble a frame out in thirds
+            if (!source.sendStalled()) {
+                source.disconnect();
+            }
+            return nowMs();
+        }
+        return 0;
+    });
+
+    if (haveSql) {
+        // clean stream, but the cloud endpoint vanishes for 3 s mid-run;
+        // recovery is blackhole lift -> next delivered batch (includes the
+        // spill catch-up kicking in)
+        std::thread hole([&] {
+            std::this_thread::sleep_for(std::chrono::seconds(3));
+            server.setBlackhole(true);
+            std::this_thread::sleep_for(std::chrono::seconds(3));
+            server.setBlackhole(false);
+        });
+        long long holeLiftedAt = nowMs() + 6000;
+        bool reported = false;
+        runScenario("sql blackhole", 10, [&](uint64_t) -> long long {
+            if (!reported && nowMs() >= holeLiftedAt) {
+                reported = true;
+                return holeLiftedAt;
+            }
+            return 0;
+        });
+        hole.join();
+    } else {
+        printf("%-24s skipped (no port 80)\n", "sql blackhole");
+    }
+
+    printf("\n%-24s %8s %10s %12s %10s\n", "scenario", "sent", "delivered", "sustained", "recovery");
+    for (const ScenarioResult& r : results) {
+        printf("%-24s %8llu %10llu %9.1f/s ", r.name,
+               (unsigned long long)r.sent, (unsigned long long)r.delivered, r.fps);
+        if (r.recoveryMs >= 0) {
+            printf("%7lld ms\n", r.recoveryMs);
+        } else {
+            printf("%10s\n", "-");
+        }
+    }
+
+    source.disconnect();
+    unpacker.stop();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,127 @@
+//
+// Microbenchmarks for the frame hot path. Build the telemetry_bench target
+// and run it before/after a change; ns/frame and frames/sec are printed per
+// benchmark so regressions show up in a diff of two runs.
+//
+
+#include "DataProcessor/dataUnpacker.h"
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameBuilder.h"
+#include "backend/framingParser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static std::vector<uint8_t> makeFrame() {
+    // deterministic pseudo-random frame so runs are comparable
+    std::mt19937 rng(42);
+    std::vector<uint8_t> frame(DataFormat::FRAME_SIZE);
+    for (auto& b : frame) {
+        b = (uint8_t)rng();
+    }
+    // booleans must hold 0/1, the unpacker reads them as flags
+    for (const auto& f : DataFormat::FIELDS) {
+        if (f.type == DataFormat::FieldType::Bool) {
+            frame[f.offset] &= 1;
+        }
+    }
+    return frame;
+}
+
+// Run fn `iters` times and report per-iteration cost.
+template <typename Fn>
+static void bench(const char* name, int iters, Fn&& fn) {
+    // warm caches and branch predictors before timing
+    for (int i = 0; i < iters / 10 + 1; i++) {
+        fn();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        fn();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / iters;
+    printf("%-28s %10.1f ns/frame %12.0f frames/sec\n", name, ns, 1e9 / ns);
+}
+
+static volatile double sink; // defeat dead-code elimination
+
+int main() {
+    const int iters = 100000;
+    std::vector<uint8_t> frame = makeFrame();
+
+    printf("frame size %d bytes, %d fields, %d iterations each\n\n",
+           DataFormat::FRAME_SIZE, DataFormat::FIELD_COUNT, iters);
+
+    // typed field accessors across every field of the frame
+    bench("field accessors (all)", iters, [&] {
+        double acc = 0;
+        for (const auto& f : DataFormat::FIELDS) {
+            switch (f.type) {
+                case DataFormat::FieldType::Float:
+                    acc += readField<float>(frame, f.offset);
+                    break;
+                case DataFormat::FieldType::Double:
+                    acc += readField<double>(frame, f.offset);
+                    break;
+                case DataFormat::FieldType::Uint16:
+                    acc += readField<uint16_t>(frame, f.offset);
+                    break;
+                case DataFormat::FieldType::Uint64:
+                    acc += (double)readField<uint64_t>(frame, f.offset);
+                    break;
+                default:
+                    acc += readField<uint8_t>(frame, f.offset);
+                    break;
+            }
+        }
+        sink = acc;
+    });
+
+    // tag framing as done on the ethernet receive path
+    {
+        std::vector<uint8_t> stream;
+        const char startTag[] = "<bsr>";
+        const char endTag[] = "</bsr>";
+        stream.insert(stream.end(), startTag, startTag + 5);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+        stream.insert(stream.end(), endTag, endTag + 6);
+
+        FramingParser parser(DataFormat::FRAME_SIZE);
+        size_t frames = 0;
+        bench("framing parser", iters, [&] {
+            parser.consume(stream.data(), stream.size(),
+                           [&](uint8_t*, size_t) { frames++; });
+        });
+        sink = (double)frames;
+    }
+
+    // in-place timestamping as done per frame on the backend thread
+    {
+        timestampOffsets offsets{};
+        offsets.hr = DataFormat::fieldOffset("tstamp_hr");
+        offsets.mn = DataFormat::fieldOffset("tstamp_mn");
+        offsets.sc = DataFormat::fieldOffset("tstamp_sc");
+        offsets.ms = DataFormat::fieldOffset("tstamp_ms");
+        offsets.unix = DataFormat::fieldOffset("tstamp_unix");
+        FrameBuilder builder(DataFormat::FRAME_SIZE, offsets);
+        builder.buffer() = frame;
+        long long msec = 1756700000000LL;
+        bench("timestamp stamping", iters, [&] {
+            builder.stampTimestamps(msec++);
+        });
+    }
+
+    // full unpack of a frame into the dashboard fields
+    {
+        DataUnpacker unpacker;
+        unpacker.rawBytes() = frame;
+        bench("DataUnpacker::unpack", iters, [&] {
+            unpacker.unpack();
+        });
+    }
+
+    return 0;
+}
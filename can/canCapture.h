@@ -0,0 +1,175 @@
+#ifndef CANCAPTURE_H
+#define CANCAPTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "backend/frameRing.h"
+#include "backend/telemetryLog.h"
+
+/**
+ * Native SocketCAN capture engine, replacing the python-can snooper for raw
+ * logging on the vehicle. A PF_CAN raw socket with a deep kernel receive
+ * buffer is drained in batches with recvmmsg(); fixed-width records are
+ * handed to a writer thread through the same lock-free drop-oldest ring the
+ * frame pipeline uses, and the writer appends them to mmap-backed .blog
+ * segments (TelemetryLogWriter), so TelemetryLogReader tooling can replay
+ * CAN traffic the same way as telemetry frames.
+ */
+
+// One captured frame; fixed width so segments are binary-searchable by time.
+struct CanLogRecord {
+    uint64_t timestampMs; // wall clock, same key as the telemetry log
+    uint32_t canId;       // raw can_id including EFF/RTR/ERR flag bits
+    uint8_t length;
+    uint8_t padding[3];
+    uint8_t data[8];
+};
+static_assert(sizeof(CanLogRecord) == 24, "record layout is part of the log format");
+
+class CanCapture {
+public:
+    static constexpr int BATCH = 64; // frames per recvmmsg
+
+    CanCapture(const std::string& interface, const std::string& outputDir)
+        : interface(interface),
+          ring(sizeof(CanLogRecord), 4096),
+          log(outputDir, sizeof(CanLogRecord), offsetof(CanLogRecord, timestampMs),
+              0x43414e31 /* "CAN1" - not a telemetry frame layout */) {}
+
+    ~CanCapture() {
+        stop();
+    }
+
+    bool start() {
+        fd = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+        if (fd < 0) {
+            return false;
+        }
+
+        ifreq ifr{};
+        std::strncpy(ifr.ifr_name, interface.c_str(), sizeof(ifr.ifr_name) - 1);
+        if (::ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+
+        sockaddr_can addr{};
+        addr.can_family = AF_CAN;
+        addr.can_ifindex = ifr.ifr_ifindex;
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+
+        // deep kernel ring so a fault storm queues instead of dropping
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        running = true;
+        writerThread = std::thread(&CanCapture::writerLoop, this);
+        captureThread = std::thread(&CanCapture::captureLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        if (fd >= 0) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        writerCv.notify_all();
+        if (captureThread.joinable()) {
+            captureThread.join();
+        }
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    uint64_t framesCaptured() const { return captured.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return ring.droppedOldest(); }
+
+private:
+    void captureLoop() {
+        can_frame frames[BATCH];
+        iovec iovs[BATCH];
+        mmsghdr msgs[BATCH];
+        for (int i = 0; i < BATCH; i++) {
+            iovs[i] = {&frames[i], sizeof(can_frame)};
+            std::memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        while (running) {
+            int n = ::recvmmsg(fd, msgs, BATCH, MSG_WAITFORONE, nullptr);
+            if (n <= 0) {
+                if (running && (errno == EINTR || errno == EAGAIN)) {
+                    continue;
+                }
+                break;
+            }
+            uint64_t now = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            for (int i = 0; i < n; i++) {
+                CanLogRecord record{};
+                record.timestampMs = now;
+                record.canId = frames[i].can_id;
+                record.length = frames[i].can_dlc;
+                std::memcpy(record.data, frames[i].data, sizeof(record.data));
+                ring.push(reinterpret_cast<const uint8_t*>(&record), sizeof(record));
+            }
+            captured.fetch_add((uint64_t)n, std::memory_order_relaxed);
+            writerCv.notify_one();
+        }
+    }
+
+    void writerLoop() {
+        std::vector<uint8_t> record(sizeof(CanLogRecord));
+        std::unique_lock<std::mutex> lock(writerMutex);
+        while (running || ring.size() > 0) {
+            writerCv.wait_for(lock, std::chrono::milliseconds(100));
+            lock.unlock();
+            while (ring.pop(record)) {
+                log.append(record.data());
+            }
+            lock.lock();
+        }
+    }
+
+    std::string interface;
+    int fd = -1;
+    std::atomic<bool> running = false;
+    std::atomic<uint64_t> captured = 0;
+
+    FrameRing ring;
+    TelemetryLogWriter log;
+
+    std::mutex writerMutex;
+    std::condition_variable writerCv;
+    std::thread captureThread;
+    std::thread writerThread;
+};
+
+#endif // CANCAPTURE_H
@@ -0,0 +1,52 @@
+//
+// Standalone CAN capture tool: logs raw SocketCAN traffic to indexed .blog
+// segments. Replaces running the python can-snooper beside the main binary.
+//
+//   can_capture [interface] [output-dir]
+//
+
+#include "can/canCapture.h"
+
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void onSignal(int) {
+    interrupted = 1;
+}
+
+int main(int argc, char** argv) {
+    std::string interface = argc > 1 ? argv[1] : "can0";
+    std::string outputDir = argc > 2 ? argv[2]
+        : std::filesystem::temp_directory_path().string() + "/driver-io-can-log/";
+    if (!std::filesystem::exists(outputDir)) {
+        std::filesystem::create_directory(outputDir);
+    }
+
+    CanCapture capture(interface, outputDir);
+    if (!capture.start()) {
+        std::cerr << "could not open CAN interface " << interface << std::endl;
+        return 1;
+    }
+    std::cout << "capturing " << interface << " to " << outputDir << std::endl;
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    uint64_t lastCaptured = 0;
+    while (!interrupted) {
+        sleep(5);
+        uint64_t captured = capture.framesCaptured();
+        std::cout << "captured " << captured << " frames ("
+                  << (captured - lastCaptured) / 5 << "/s), dropped "
+                  << capture.framesDropped() << std::endl;
+        lastCaptured = captured;
+    }
+
+    capture.stop();
+    std::cout << "done: " << capture.framesCaptured() << " frames, "
+              << capture.framesDropped() << " dropped" << std::endl;
+    return 0;
+}
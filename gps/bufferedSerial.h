@@ -0,0 +1,91 @@
+#ifndef BUFFEREDSERIAL_H
+#define BUFFEREDSERIAL_H
+
+#include "3rdparty/serial/serialib.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Buffered reader layered on serialib. serialib::readString pulls bytes one
+ * read() syscall at a time while scanning for the terminator; this reader
+ * does one read() into a 4 kB buffer, scans in memory, and carries leftover
+ * bytes to the next call, so a line costs one syscall instead of one per
+ * byte. Use one reader per opened device and reset() after reopening it.
+ */
+class BufferedSerialReader {
+public:
+    explicit BufferedSerialReader(serialib& serial) : serial(serial) {}
+
+    // Drop any buffered leftover (call after reopening the device).
+    void reset() {
+        start = 0;
+        end = 0;
+    }
+
+    /**
+     * Read until terminator or timeout. The terminator is consumed but not
+     * stored. Returns the number of characters placed into line, 0 on
+     * timeout with nothing complete, -1 on device error.
+     */
+    int readLine(char* line, size_t maxLen, char terminator, unsigned int timeoutMs) {
+#ifdef __linux__
+        size_t lineLen = 0;
+        while (true) {
+            // serve from the buffer first
+            while (start < end) {
+                char c = buf[start++];
+                if (c == terminator) {
+                    return (int)lineLen;
+                }
+                if (lineLen < maxLen) {
+                    line[lineLen++] = c;
+                }
+            }
+
+            // buffer exhausted: one poll, one bulk read
+            pollfd p{serial.getFileDescriptor(), POLLIN, 0};
+            int ready = ::poll(&p, 1, (int)timeoutMs);
+            if (ready < 0 || (p.revents & (POLLERR | POLLHUP))) {
+                return -1;
+            }
+            if (ready == 0) {
+                return 0;
+            }
+            ssize_t n = ::read(serial.getFileDescriptor(), buf, sizeof(buf));
+            if (n <= 0) {
+                return -1;
+            }
+            start = 0;
+            end = (size_t)n;
+        }
+#else
+        (void)line;
+        (void)maxLen;
+        (void)terminator;
+        (void)timeoutMs;
+        return -1;
+#endif
+    }
+
+    // Convenience overload for callers that keep responses in a string.
+    int readLine(std::string& line, char terminator, unsigned int timeoutMs) {
+        char local[512];
+        int n = readLine(local, sizeof(local), terminator, timeoutMs);
+        line.assign(local, n > 0 ? (size_t)n : 0);
+        return n;
+    }
+
+private:
+    serialib& serial;
+    char buf[4096];
+    size_t start = 0; // next buffered byte to serve
+    size_t end = 0;   // one past the last valid buffered byte
+};
+
+#endif // BUFFEREDSERIAL_H
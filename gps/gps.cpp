@@ -1,10 +1,21 @@
 #include "gps.h"
+#include "bufferedSerial.h"
+#include "nmeaParser.h"
+#include "backend/heartbeat.h"
+#include "backend/metrics.h"
+#include <algorithm>
 #include <string>
 #include <stdio.h>
 #include <filesystem>
-#include <sstream>
+#include <fstream>
 #include <iostream>
-#include <qdebug.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 using namespace std;
 
@@ -30,104 +41,163 @@ GPS::GPS() {
 
 GPS::~GPS() {
     serial.closeDevice();
+    if(inotifyFd >= 0) {
+        close(inotifyFd);
+    }
 }
 
 bool GPS::init(string device) {
-    int errorOpen = serial.openDevice(device.c_str(), 115200);
-    if(serial.isDeviceOpen()) {
+    // own handle per call so concurrent probes never share serial state
+    serialib port;
+    int errorOpen = port.openDevice(device.c_str(), 115200);
+    if(port.isDeviceOpen()) {
         string resp;
         //flush any previous input
-        serial.writeString("\r\n");
+        port.writeString("\r\n");
         //Set AT no echo back
-        serial.writeString("ATE0\r\n");
+        port.writeString("ATE0\r\n");
         //send initital AT
-        serial.writeString("AT\r\n");
-        serial.readString(resp, '*', 10, 1000);
+        port.writeString("AT\r\n");
+        port.readString(resp, '*', 10, 1000);
         if(resp.find("OK") == string::npos) {
             // if does not return ok initialize failed
             return false;
         }
-        
+
         // config gps mode
-        serial.writeString("AT+QGPSCFG=\"outport\",\"usbnmea\"\r\n");
-        serial.readString(resp, '*', 10, 1000);
+        port.writeString("AT+QGPSCFG=\"outport\",\"usbnmea\"\r\n");
+        port.readString(resp, '*', 10, 1000);
         if(resp.find("OK") == string::npos) {
             // if does not return ok initialize failed
             return false;
         }
 
         // turn on gps
-        serial.writeString("AT+QGPS=1\r\n");
-        serial.readString(resp, '*', 20, 1000);
+        port.writeString("AT+QGPS=1\r\n");
+        port.readString(resp, '*', 20, 1000);
         if(resp.find("OK") == string::npos && resp.find("504") == string::npos) {
             // if not ok or 504 (session ongoing) then init failed
             return false;
         }
-        serial.closeDevice();
+        port.closeDevice();
         return true;
     }
     cout << "Error opening ttyUSB3, check usb connection, are you running with sudo?\n";
     return false;
 }
 
-// Degree and decimal minute to decimal degree
-string ddm2dd(string ddm) {
-    double value = stod(ddm);
-    double deg = int(value) / 100;
-    double min = value - deg * 100;
-    double val = deg + min/60;
-    return to_string(val);
+void GPS::handleSentence(const char* sentence, size_t len) {
+    // tokenize in place; -1 means the *hh checksum didn't match
+    nmea::Tokenizer tok;
+    int fieldCount = tok.tokenize(sentence, len);
+    if(fieldCount < 0) {
+        return;
+    }
+    static Heartbeat& heartbeat = PipelineWatchdog::getInstance().stage("gps");
+    heartbeat.beat();
+    // Format Docs: https://docs.novatel.com/OEM7/Content/Logs/GPGGA.htm
+    if (fieldCount > 9 && tok[0].equals("GPGGA")){
+        static Gauge& fixValid = MetricsRegistry::getInstance().gauge("gps_fix_valid");
+        fixValid.set(tok[6].first() != '0');
+        if(tok[6].first() == '0') {
+            lat = -1001;
+            lon = -1001;
+            alt = -1001;
+        } else {
+            double latDd = nmea::ddm2dd(tok[2].toDouble());
+            double lonDd = nmea::ddm2dd(tok[4].toDouble());
+            lat = (float)(tok[3].first() == 'N' ? latDd : -latDd);
+            lon = (float)(tok[5].first() == 'E' ? lonDd : -lonDd);
+            alt = (float)tok[9].toDouble();
+        }
+    }
 }
 
-GPSData parseNMEA(vector<string> nmeaGGA) {
-    // Format Docs: https://docs.novatel.com/OEM7/Content/Logs/GPGGA.htm
-    GPSData gpsd;
-    gpsd.lat = stod(nmeaGGA[3] == "N" ? ddm2dd(nmeaGGA[2]) : '-' + ddm2dd(nmeaGGA[2]));
-    gpsd.lon = stod(nmeaGGA[5] == "E" ? ddm2dd(nmeaGGA[4]) : '-' + ddm2dd(nmeaGGA[4]));
-    gpsd.alt = stod(nmeaGGA[9]);
-    return gpsd;
-} 
+void GPS::waitForDeviceChange(int timeoutMs) {
+#ifdef __linux__
+    if(inotifyFd >= 0) {
+        pollfd p{inotifyFd, POLLIN, 0};
+        if(::poll(&p, 1, timeoutMs) > 0 && (p.revents & POLLIN)) {
+            // drain the events; the caller rescans /dev either way
+            char buf[4096];
+            ssize_t ignored = ::read(inotifyFd, buf, sizeof(buf));
+            (void)ignored;
+        }
+        return;
+    }
+#endif
+    sleep(timeoutMs / 1000 ? timeoutMs / 1000 : 1);
+}
 
 void GPS::start_loop(string nmeaDevice) {
     // listen on /dev/ttyUSB1 for NMEA sentence
     int errorOpen = serial.openDevice(nmeaDevice.c_str(), 115200);
+#ifdef __linux__
     if(serial.isDeviceOpen()) {
         cout << "device opened\n";
-        int retry_cout = 0;
-        while(true){
-            string resp;
-            int readCode = serial.readString(resp, '$', 300, 1000);
-            if(readCode == 0) {
-                retry_cout ++;
-            } else {
-                retry_cout = 0;
+        // Event-driven read loop: poll() wakes the moment NMEA bytes or a
+        // /dev hotplug event arrive instead of sitting in second-long
+        // blocking reads. Sentences are assembled in a fixed buffer between
+        // '$' delimiters and handed to the zero-allocation tokenizer.
+        char sentence[512];
+        size_t sentenceLen = 0;
+        bool inSentence = false;
+        int idleMs = 0;
+        while(true) {
+            pollfd fds[2];
+            fds[0] = {serial.getFileDescriptor(), POLLIN, 0};
+            nfds_t nfds = 1;
+            if(inotifyFd >= 0) {
+                fds[1] = {inotifyFd, POLLIN, 0};
+                nfds = 2;
             }
-
-            if(retry_cout > 5) {
+            int ready = ::poll(fds, nfds, 1000);
+            if(ready < 0) {
                 break;
             }
-            // read data from string stream
-            vector<string> fields;
-            stringstream ss(resp);
-            while(ss.good()) {
-                string field;
-                getline(ss, field, ',');
-                fields.push_back(field);
+            if(ready == 0) {
+                // same give-up threshold as the old 5 retries of 1 s reads
+                idleMs += 1000;
+                if(idleMs > 5000) {
+                    break;
+                }
+                continue;
             }
-            if (fields[0] == "GPGGA" && fields.size() > 9){
-                if(fields[6] == "0") {
-                    lat = -1001;
-                    lon = -1001;
-                    alt = -1001;
-                } else {
-                    GPSData gpsd = parseNMEA(fields);
-                    lat = gpsd.lat;
-                    lon = gpsd.lon;
-                    alt = gpsd.alt;
+            if(nfds == 2 && (fds[1].revents & POLLIN)) {
+                char buf[4096];
+                ssize_t ignored = ::read(inotifyFd, buf, sizeof(buf));
+                (void)ignored;
+                // react to unplug immediately rather than via a read timeout
+                if(!filesystem::exists(nmeaDevice)) {
+                    break;
+                }
+            }
+            if(fds[0].revents & (POLLERR | POLLHUP)) {
+                break;
+            }
+            if(fds[0].revents & POLLIN) {
+                char buf[512];
+                ssize_t n = ::read(serial.getFileDescriptor(), buf, sizeof(buf));
+                if(n <= 0) {
+                    break;
+                }
+                idleMs = 0;
+                for(ssize_t i = 0; i < n; i++) {
+                    if(buf[i] == '$') {
+                        if(inSentence && sentenceLen > 0) {
+                            handleSentence(sentence, sentenceLen);
+                        }
+                        sentenceLen = 0;
+                        inSentence = true;
+                    } else if(inSentence && sentenceLen < sizeof(sentence)) {
+                        sentence[sentenceLen++] = buf[i];
+                    }
                 }
             }
         }
+        serial.closeDevice();
     }
+#endif
     lat = -1000;
     lon = -1000;
     alt = -1000;
@@ -138,45 +208,118 @@ GPSData GPS::getLoc(){
     return GPSData{lat, lon, alt};
 }
 
+// Where the winning AT port is remembered between runs
+static string deviceCachePath() {
+    return filesystem::temp_directory_path().string() + "/driver-io-gps-device";
+}
+
+string GPS::cachedDevice() {
+    ifstream in(deviceCachePath());
+    string device;
+    getline(in, device);
+    return device;
+}
+
+void GPS::cacheDevice(const string& device) {
+    ofstream out(deviceCachePath(), ios::trunc);
+    out << device << '\n';
+}
+
+// Fan the AT handshake out over every candidate at once, each probe with
+// its own serial handle; the first port that completes the handshake wins.
+// Worst-case discovery costs one handshake deadline instead of one per
+// enumerated port.
+string GPS::probeAll(const vector<string>& devices) {
+    mutex winnerMutex;
+    string winner;
+    vector<thread> probes;
+    for(const string& device : devices) {
+        probes.emplace_back([this, &winnerMutex, &winner, device]() {
+            if(init(device)) {
+                lock_guard<mutex> lock(winnerMutex);
+                if(winner.empty()) {
+                    winner = device;
+                }
+            }
+        });
+    }
+    for(thread& probe : probes) {
+        probe.join();
+    }
+    return winner;
+}
+
 string GPS::usbnmeaprobe(vector<string> devices) {
-    for(string device : devices) {
-        int errorOpen = serial.openDevice(device.c_str(), 115200);
-        if(serial.isDeviceOpen()) {
-            string resp;
-            int readCode = serial.readString(resp, '$', 300, 1000);
-            if (readCode != 0) {
-                cout << "device found: "<<device << '\n';
-                return device;
+    // same first-success-wins fan-out as the AT probe: every port listens
+    // for a '$' concurrently, so this stage costs one deadline overall
+    mutex winnerMutex;
+    string winner;
+    vector<thread> probes;
+    for(const string& device : devices) {
+        probes.emplace_back([&winnerMutex, &winner, device]() {
+            serialib port;
+            int errorOpen = port.openDevice(device.c_str(), 115200);
+            if(!port.isDeviceOpen()) {
+                return;
             }
-        }
+            // one bulk read per probe instead of per-byte readString syscalls
+            BufferedSerialReader reader(port);
+            char line[300];
+            int readCode = reader.readLine(line, sizeof(line), '$', 1000);
+            if (readCode > 0) {
+                lock_guard<mutex> lock(winnerMutex);
+                if(winner.empty()) {
+                    cout << "device found: "<<device << '\n';
+                    winner = device;
+                }
+            }
+        });
     }
-    cout << "No NMEA device found\n";
-    return "";
+    for(thread& probe : probes) {
+        probe.join();
+    }
+    if(winner.empty()) {
+        cout << "No NMEA device found\n";
+    }
+    return winner;
 }
 void GPS::autoInit() {
+#ifdef __linux__
+    // watch /dev so plugging or pulling the modem wakes us immediately
+    // instead of being noticed on the next sleep-and-rescan cycle
+    inotifyFd = inotify_init1(IN_NONBLOCK);
+    if(inotifyFd >= 0 && inotify_add_watch(inotifyFd, "/dev", IN_CREATE | IN_DELETE) < 0) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+#endif
     while(true) {
         vector<string>deviceList = listUSB();
         if(deviceList.size() == 0) {
-            sleep(1);
+            // wake on the next /dev change; rescan once a minute regardless
+            waitForDeviceChange(60000);
             continue;
         }
-        int deviceIndex = 0;
-        // trial and error to find which device to open since device number is not fixed
-        while(true) {
-            initSuccess = init(deviceList[deviceIndex]);
-            if (initSuccess) {
-                string nmeaDevice = usbnmeaprobe(deviceList);
-                if(nmeaDevice != "")
-                    start_loop(nmeaDevice);
-            } else {
-                deviceIndex ++;
-            }
-            // if all device fail, refresh device list and retry
-            if(deviceIndex >= deviceList.size()) {
-                break;
-            }
-            sleep(3);
+        // the port that won last run gets a solo attempt first - on an
+        // unchanged wiring loom that skips spraying AT commands at every
+        // other enumerated serial device - then the concurrent fan-out
+        // covers the device number having moved
+        string atDevice = cachedDevice();
+        if(atDevice.empty() ||
+           find(deviceList.begin(), deviceList.end(), atDevice) == deviceList.end() ||
+           !init(atDevice)) {
+            atDevice = probeAll(deviceList);
+        }
+        if(atDevice != "") {
+            cacheDevice(atDevice);
+            initSuccess = true;
+            string nmeaDevice = usbnmeaprobe(deviceList);
+            if(nmeaDevice != "")
+                start_loop(nmeaDevice);
+            initSuccess = false;
         }
-        initSuccess = false;
+        // every candidate refused, or the NMEA loop ended (unplug/stall):
+        // wait for a /dev change and rescan
+        waitForDeviceChange(3000);
     }
 }
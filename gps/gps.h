@@ -6,7 +6,6 @@
 #include <string>
 #include <atomic>
 #include <vector>
-#include <QObject>
 
 using namespace std;
 
@@ -16,8 +15,7 @@ struct GPSData {
     float alt;
 };
 
-class GPS : public QObject{
-    Q_OBJECT
+class GPS {
 public:
     GPS();
     ~GPS();
@@ -25,13 +23,22 @@ public:
     bool initialized();
     void start_loop(string nmeaDevice);
     GPSData getLoc();
-public slots:
     void autoInit(); // automatically find and init gps device
 private:
     string usbnmeaprobe(vector<string> devices);
+    // probe every candidate concurrently, first successful AT handshake wins
+    string probeAll(const vector<string>& devices);
+    // winning AT port persisted across runs, tried alone on the next boot
+    string cachedDevice();
+    void cacheDevice(const string& device);
+    // block until /dev changes (device add/remove) or timeoutMs elapses
+    void waitForDeviceChange(int timeoutMs);
+    // parse one NMEA sentence payload and update the fix
+    void handleSentence(const char* sentence, size_t len);
     serialib serial;
+    int inotifyFd = -1; // watches /dev for hotplug events
     atomic<bool> initSuccess = false;
     atomic<float> lat=-1000, lon=-1000, alt=-1000;
 };
 
-#endif // GPS_H
\ No newline at end of file
+#endif // GPS_H
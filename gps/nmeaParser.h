@@ -0,0 +1,132 @@
+#ifndef NMEAPARSER_H
+#define NMEAPARSER_H
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Fixed-buffer NMEA tokenizer. Fields are views into the caller's sentence
+ * buffer and numbers are parsed directly from those views, so a sentence is
+ * processed with zero heap allocations - the GPS loop runs forever at a few
+ * sentences per second and should not show up in the allocation profile.
+ * The trailing *hh checksum is validated when present (NMEA 0183).
+ */
+namespace nmea {
+
+// View into one comma-separated field of a sentence buffer.
+struct Field {
+    const char* ptr = nullptr;
+    size_t len = 0;
+
+    bool empty() const { return len == 0; }
+
+    char first() const { return len ? ptr[0] : '\0'; }
+
+    bool equals(const char* s) const {
+        return std::strlen(s) == len && std::memcmp(ptr, s, len) == 0;
+    }
+
+    // Direct numeric parse (sign, digits, fraction); NMEA carries nothing
+    // fancier. No copies, no locale, no allocation.
+    double toDouble() const {
+        const char* p = ptr;
+        const char* end = ptr + len;
+        if (p == end) {
+            return 0.0;
+        }
+        double sign = 1.0;
+        if (*p == '-' || *p == '+') {
+            sign = *p == '-' ? -1.0 : 1.0;
+            p++;
+        }
+        double value = 0.0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10.0 + (*p - '0');
+            p++;
+        }
+        if (p < end && *p == '.') {
+            p++;
+            double scale = 0.1;
+            while (p < end && *p >= '0' && *p <= '9') {
+                value += (*p - '0') * scale;
+                scale *= 0.1;
+                p++;
+            }
+        }
+        return sign * value;
+    }
+};
+
+// Degree-and-decimal-minute (ddmm.mmmm) to decimal degrees.
+inline double ddm2dd(double ddm) {
+    int deg = (int)(ddm / 100.0);
+    return deg + (ddm - deg * 100.0) / 60.0;
+}
+
+class Tokenizer {
+public:
+    static constexpr int MAX_FIELDS = 24; // GGA has 15; headroom for others
+
+    /**
+     * Tokenize one sentence payload (after the '$', CR/LF or terminator
+     * anywhere after it is fine). Returns the field count, or -1 when a
+     * trailing *hh checksum is present and does not match.
+     */
+    int tokenize(const char* s, size_t maxLen) {
+        count = 0;
+        unsigned checksum = 0;
+        const char* fieldStart = s;
+        const char* p = s;
+        const char* end = s + maxLen;
+
+        while (p < end && *p != '\0' && *p != '*' && *p != '\r' && *p != '\n' && *p != '$') {
+            checksum ^= (unsigned char)*p;
+            if (*p == ',') {
+                addField(fieldStart, p);
+                fieldStart = p + 1;
+            }
+            p++;
+        }
+        addField(fieldStart, p);
+
+        if (p < end && *p == '*') {
+            // two hex digits follow; reject the sentence on any mismatch
+            if (p + 2 >= end) {
+                return -1;
+            }
+            int hi = hexDigit(p[1]);
+            int lo = hexDigit(p[2]);
+            if (hi < 0 || lo < 0 || (unsigned)(hi * 16 + lo) != checksum) {
+                return -1;
+            }
+        }
+        return count;
+    }
+
+    const Field& operator[](int i) const { return fields[i]; }
+
+    int fieldCount() const { return count; }
+
+private:
+    void addField(const char* start, const char* end) {
+        if (count < MAX_FIELDS) {
+            fields[count].ptr = start;
+            fields[count].len = (size_t)(end - start);
+            count++;
+        }
+    }
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    Field fields[MAX_FIELDS];
+    int count = 0;
+};
+
+} // namespace nmea
+
+#endif // NMEAPARSER_H
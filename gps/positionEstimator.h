@@ -0,0 +1,105 @@
+#ifndef POSITIONESTIMATOR_H
+#define POSITIONESTIMATOR_H
+
+#include <cstdint>
+#include "gps/gps.h"
+
+/**
+ * Dead-reckons position between 1 Hz GPGGA fixes so every frame carries a
+ * fresh coordinate instead of repeating the last fix at the frame rate.
+ *
+ * The course and ground speed come from the displacement between the last
+ * two fixes (in degrees per second, so no geodesy constants are needed);
+ * between fixes the vehicle's decoded speed field modulates that velocity,
+ * so braking or accelerating mid-second bends the estimate the right way.
+ * A new fix always snaps the output back to the raw measurement - the
+ * logged track still contains every real fix - and estimation stops when
+ * fixes go stale or were never valid.
+ */
+class PositionEstimator {
+public:
+    // Feed the current raw fix and this frame's decoded speed; returns the
+    // position to stamp into the frame. nowMs is wall time in milliseconds.
+    GPSData apply(const GPSData& fix, float frameSpeed, int64_t nowMs) {
+        // no fix (receiver reports -1000/-1001 sentinels): nothing to reckon
+        if (fix.lat < -90.0f || fix.lat > 90.0f) {
+            haveFix = false;
+            haveVelocity = false;
+            return fix;
+        }
+
+        if (!haveFix || fix.lat != lastFix.lat || fix.lon != lastFix.lon) {
+            // a new fix: derive the velocity vector from the last two fixes,
+            // remember the speed it was observed at, and snap to the raw fix
+            int64_t dtMs = nowMs - lastFixMs;
+            if (haveFix && dtMs > MIN_FIX_GAP_MS && dtMs < MAX_FIX_GAP_MS) {
+                double dtSec = (double)dtMs / 1000.0;
+                velLatPerSec = ((double)fix.lat - (double)lastFix.lat) / dtSec;
+                velLonPerSec = ((double)fix.lon - (double)lastFix.lon) / dtSec;
+                speedAtFix = frameSpeed;
+                haveVelocity = true;
+            } else {
+                haveVelocity = false;
+            }
+            lastFix = fix;
+            lastFixMs = nowMs;
+            haveFix = true;
+            estLat = fix.lat;
+            estLon = fix.lon;
+            lastStepMs = nowMs;
+            estimated = false;
+            return fix;
+        }
+
+        // same fix as last frame: extrapolate, unless the velocity is
+        // unknown or the receiver has gone quiet for too long
+        if (!haveVelocity || nowMs - lastFixMs > MAX_COAST_MS) {
+            estimated = false;
+            return fix;
+        }
+
+        // scale the fix-derived velocity by how the vehicle's speed has
+        // changed since the fix; the ratio also absorbs whatever unit the
+        // speed field is in
+        double scale = 1.0;
+        if (speedAtFix > MIN_SPEED) {
+            scale = (double)frameSpeed / (double)speedAtFix;
+            if (scale < 0.0) scale = 0.0;
+            if (scale > 2.0) scale = 2.0;
+        }
+        double stepSec = (double)(nowMs - lastStepMs) / 1000.0;
+        estLat += velLatPerSec * scale * stepSec;
+        estLon += velLonPerSec * scale * stepSec;
+        lastStepMs = nowMs;
+        estimated = true;
+        return GPSData{(float)estLat, (float)estLon, fix.alt};
+    }
+
+    // true when the last apply() returned an extrapolated position rather
+    // than a raw fix
+    bool isEstimated() const { return estimated; }
+
+private:
+    // fix intervals outside this window don't yield a usable velocity
+    // (duplicates within a sentence burst, or a receiver dropout)
+    static constexpr int64_t MIN_FIX_GAP_MS = 200;
+    static constexpr int64_t MAX_FIX_GAP_MS = 5000;
+    // stop extrapolating this long after the last fix
+    static constexpr int64_t MAX_COAST_MS = 3000;
+    // below this the speed ratio is noise; coast on the fix velocity alone
+    static constexpr float MIN_SPEED = 1.0f;
+
+    GPSData lastFix{};
+    int64_t lastFixMs = 0;
+    bool haveFix = false;
+
+    double velLatPerSec = 0.0, velLonPerSec = 0.0; // degrees per second
+    float speedAtFix = 0.0f;
+    bool haveVelocity = false;
+
+    double estLat = 0.0, estLon = 0.0; // integrated between fixes
+    int64_t lastStepMs = 0;
+    bool estimated = false;
+};
+
+#endif // POSITIONESTIMATOR_H
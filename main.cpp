@@ -2,9 +2,13 @@
 #include <thread>
 #include <chrono>
 #include <filesystem>
-#include <cstdlib>
 #include <signal.h>
+#include <Config.h>
 #include <DataProcessor/dataUnpacker.h>
+#include <backend/fileSyncUploader.h>
+#include <backend/heartbeat.h>
+#include <backend/metricsServer.h>
+#include <backend/raceMode.h>
 
 // Global flag for clean shutdown
 volatile bool g_running = true;
@@ -15,33 +19,6 @@ void signalHandler(int signal) {
     g_running = false;
 }
 
-// Function to start file sync process
-void startFileSync() {
-    // Check for file_sync/file_sync_up/main.py in different locations
-    std::filesystem::path sync_paths[] = {
-        "../backend/file_sync/file_sync_up/main.py",
-        "./backend/file_sync/file_sync_up/main.py"
-    };
-    
-    for (const auto& path : sync_paths) {
-        if (std::filesystem::exists(path) && std::filesystem::is_regular_file(path)) {
-            std::cout << "Starting file sync from: " << path << std::endl;
-            std::string command = "python3 " + path.string() + " &";
-            int result = std::system(command.c_str());
-            if (result == 0) {
-                std::cout << "File sync started successfully" << std::endl;
-                return;
-            } else {
-                std::cout << "Failed to start file sync process" << std::endl;
-            }
-        }
-    }
-    
-    std::cout << "\nWARNING: running without file sync" << std::endl;
-    std::cout << "   * Check whether you've cloned all the submodules" << std::endl;
-    std::cout << "   * If that didn't work, your build output is probably in a nonstandard directory" << std::endl;
-}
-
 int main(int argc, char *argv[]) {
     std::cout << "SC2 Driver IO - Headless Telemetry System" << std::endl;
     std::cout << "===========================================" << std::endl;
@@ -50,28 +27,65 @@ int main(int argc, char *argv[]) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
+    // Race mode pins the process into RAM before anything large is mapped,
+    // so the log segments and pool slabs below arrive locked and populated
+    if (Config::getInstance().settings().raceMode) {
+        engageRaceMode();
+    }
+
     // Initialize the data unpacker (telemetry processor)
     DataUnpacker unpacker;
+
+    // Start the in-process file sync uploader (used to be a spawned python
+    // child); it uploads closed segments and deletes them on server ack
+    FileSyncUploader fileSync(
+        std::filesystem::temp_directory_path().string() + "/driver-io-file-sync/");
+    fileSync.setStatusCallback([](uint64_t uploaded, uint64_t failed, uint64_t pending) {
+        if (pending > 0 || failed > 0) {
+            std::cout << "file sync: " << uploaded << " uploaded, " << failed
+                      << " failed, " << pending << " pending" << std::endl;
+        }
+    });
+    fileSync.start();
+    // the uploader beats a "filesync" heartbeat; if it dies or wedges, the
+    // watchdog bounces the worker thread the same way it kicks the fetcher
+    PipelineWatchdog::getInstance().setRestart("filesync", [&fileSync]() {
+        fileSync.stop();
+        fileSync.start();
+    });
     
-    // Start file sync process in background
-    startFileSync();
-    
+    // Scrape endpoint over the pipeline's counters, plus periodic dumps
+    // into the file-sync directory so offline runs keep their numbers
+    MetricsServer metrics(
+        Config::getInstance().settings().metricsPort,
+        std::filesystem::temp_directory_path().string() + "/driver-io-file-sync/");
+    metrics.start();
+
     // Start the telemetry processing
     std::cout << "Starting telemetry data processing..." << std::endl;
     unpacker.start();
-    
-    // Main application loop
+
+    // Watch config.json for edits: tunables swap in live instead of costing
+    // a restart. Started after the pipeline so every component has had a
+    // chance to register its change callback.
+    Config::getInstance().startWatcher();
+
+    // Main application loop doubles as the pipeline supervisor: every stage
+    // bumps a heartbeat counter as it makes progress, and poll() turns those
+    // into rate lines, stall warnings and (for stages with a restart hook)
+    // a kick for anything wedged
     std::cout << "System running. Press Ctrl+C to shutdown gracefully." << std::endl;
     while (g_running) {
-        // Sleep for a short period to avoid busy waiting
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        // Here we could add periodic status checks or maintenance tasks
-        // For now, just keep the application alive
+        PipelineWatchdog::getInstance().poll(std::cout);
     }
     
-    // Graceful shutdown
+    // Graceful shutdown; the watcher goes first so no reload callback can
+    // land in a component that is tearing down
     std::cout << "Shutting down telemetry system..." << std::endl;
+    Config::getInstance().stopWatcher();
+    metrics.stop();
+    fileSync.stop();
     unpacker.stop();
     
     std::cout << "SC2 Driver IO shutdown complete." << std::endl;
@@ -0,0 +1,58 @@
+"""Reader for the driver-io shared-memory snapshot segment.
+
+The C++ side (DataUnpacker) publishes every decoded field into
+/dev/shm/driver-io-snapshot under a seqlock after each frame. Reading is
+lock-free: grab seq, copy the values, re-read seq - if both reads are equal
+and even the copy is consistent, otherwise retry.
+
+Usage:
+    snap = ShmSnapshot()
+    fields = snap.read()   # {"speed": 12.3, ...} or None if no segment yet
+"""
+
+import mmap
+import struct
+
+SEGMENT_PATH = "/dev/shm/driver-io-snapshot"
+HEADER_FORMAT = "<4sIIIQ"  # magic, version, layout hash, field count, seq
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+NAME_LEN = 48
+SEQ_OFFSET = HEADER_SIZE - 8
+
+
+class ShmSnapshot:
+    def __init__(self, path=SEGMENT_PATH):
+        self.path = path
+        self.mem = None
+        self.names = []
+
+    def _open(self):
+        with open(self.path, "rb") as f:
+            self.mem = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+        magic, version, _layout_hash, field_count, _seq = struct.unpack_from(
+            HEADER_FORMAT, self.mem, 0)
+        if magic != b"BSHM" or version != 1:
+            raise ValueError("unrecognized snapshot segment layout")
+        self.names = []
+        for i in range(field_count):
+            raw = self.mem[HEADER_SIZE + i * NAME_LEN:HEADER_SIZE + (i + 1) * NAME_LEN]
+            self.names.append(raw.split(b"\0", 1)[0].decode())
+        self.values_offset = HEADER_SIZE + field_count * NAME_LEN
+
+    def read(self, retries=5):
+        """Return {field name: value} or None if no consistent snapshot yet."""
+        if self.mem is None:
+            try:
+                self._open()
+            except (FileNotFoundError, ValueError):
+                return None
+        for _ in range(retries):
+            (seq_before,) = struct.unpack_from("<Q", self.mem, SEQ_OFFSET)
+            if seq_before == 0 or seq_before % 2 == 1:
+                continue  # nothing published yet, or a write is in progress
+            values = struct.unpack_from(
+                "<%dd" % len(self.names), self.mem, self.values_offset)
+            (seq_after,) = struct.unpack_from("<Q", self.mem, SEQ_OFFSET)
+            if seq_before == seq_after:
+                return dict(zip(self.names, values))
+        return None
@@ -0,0 +1,128 @@
+// Extract frames from a black-box recorder file (backend/blackBox.h).
+//
+//   blackbox_extract <blackbox.bin> [--list]
+//
+// Default mode inflates every valid segment in sequence order and writes the
+// frames to stdout as a v2 framed stream (backend/frameCodec.h), so the
+// output can be fed straight into frame_replay or any other consumer of the
+// wire format. --list prints one summary line per segment instead.
+
+#include "backend/blackBox.h"
+#include "backend/frameCodec.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+struct Segment {
+    BlackBox::SegmentHeader hdr;
+    off_t offset;
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <blackbox.bin> [--list]\n", argv[0]);
+        return 1;
+    }
+    bool list = argc > 2 && std::string(argv[2]) == "--list";
+
+    int fd = ::open(argv[1], O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+    struct stat st{};
+    fstat(fd, &st);
+
+    // The slot size is not recorded in the file, but slots are power-of-two
+    // sized and at least 64 kB, so every segment header sits on a 64 kB
+    // boundary. Scan at that granularity and skip offsets inside the payload
+    // of an already-accepted header, so compressed bytes can't fake one;
+    // recordings made with any slot size extract the same way.
+    static constexpr off_t PROBE_STRIDE = 64 * 1024;
+    std::vector<Segment> segments;
+    off_t payloadEnd = 0;
+    for (off_t off = 0; off + (off_t)sizeof(BlackBox::SegmentHeader) <= st.st_size;
+         off += PROBE_STRIDE) {
+        if (off < payloadEnd) {
+            continue;
+        }
+        BlackBox::SegmentHeader hdr{};
+        if (::pread(fd, &hdr, sizeof(hdr), off) != sizeof(hdr)) {
+            break;
+        }
+        if (memcmp(hdr.magic, "BSEG", 4) == 0 && hdr.version == BlackBox::SEGMENT_VERSION &&
+            off + (off_t)sizeof(hdr) + (off_t)hdr.compressedBytes <= st.st_size) {
+            segments.push_back({hdr, off});
+            payloadEnd = off + (off_t)sizeof(hdr) + (off_t)hdr.compressedBytes;
+        }
+    }
+    if (segments.empty()) {
+        fprintf(stderr, "no BSEG segment found in %s (not a black-box recording, "
+                        "or written by an incompatible version)\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment& a, const Segment& b) { return a.hdr.sequence < b.hdr.sequence; });
+
+    uint64_t frames = 0;
+    std::vector<uint8_t> compressed, raw;
+    for (const Segment& seg : segments) {
+        if (list) {
+            printf("segment %8llu  %u frame(s)  %u -> %u bytes  %lld..%lld  layout %08x\n",
+                   (unsigned long long)seg.hdr.sequence, seg.hdr.frameCount,
+                   seg.hdr.rawBytes, seg.hdr.compressedBytes,
+                   (long long)seg.hdr.firstTimestamp, (long long)seg.hdr.lastTimestamp,
+                   seg.hdr.layoutHash);
+            frames += seg.hdr.frameCount;
+            continue;
+        }
+
+        compressed.resize(seg.hdr.compressedBytes);
+        if (::pread(fd, compressed.data(), compressed.size(),
+                    seg.offset + (off_t)sizeof(BlackBox::SegmentHeader)) != (ssize_t)compressed.size()) {
+            continue;
+        }
+        if ((uint32_t)::crc32(0, compressed.data(), (uInt)compressed.size()) != seg.hdr.crc32) {
+            fprintf(stderr, "segment %llu: checksum mismatch, skipped\n",
+                    (unsigned long long)seg.hdr.sequence);
+            continue;
+        }
+        raw.resize(seg.hdr.rawBytes);
+        uLongf rawLen = (uLongf)raw.size();
+        if (uncompress(raw.data(), &rawLen, compressed.data(), (uLong)compressed.size()) != Z_OK ||
+            rawLen != seg.hdr.rawBytes || seg.hdr.frameCount == 0) {
+            fprintf(stderr, "segment %llu: inflate failed, skipped\n",
+                    (unsigned long long)seg.hdr.sequence);
+            continue;
+        }
+
+        // records are [int64 timestamp][frame]; all frames in a segment are
+        // the same size
+        size_t recordBytes = seg.hdr.rawBytes / seg.hdr.frameCount;
+        for (size_t off = 0; off + recordBytes <= rawLen; off += recordBytes) {
+            const uint8_t* frame = raw.data() + off + sizeof(int64_t);
+            size_t frameLen = recordBytes - sizeof(int64_t);
+            uint8_t header[FrameCodec::HEADER_BYTES];
+            FrameCodec::writeHeader(header, (uint32_t)frameLen, seg.hdr.layoutHash,
+                                    FrameCodec::checksum(frame, frameLen));
+            fwrite(header, 1, sizeof(header), stdout);
+            fwrite(frame, 1, frameLen, stdout);
+            frames++;
+        }
+    }
+
+    fprintf(stderr, "%zu segment(s), %llu frame(s)\n", segments.size(),
+            (unsigned long long)frames);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Scan columns out of columnar log segments (backend/columnLog.h).
+//
+//   column_extract <segment.bcol>... --fields <name>[,<name>...]
+//   column_extract <segment.bcol>... --list
+//
+// Default mode prints tstamp_unix plus the requested fields as CSV, one row
+// per frame, segments in command-line order - "plot pack_current vs time"
+// is one invocation piped into a plotting script, touching only the columns
+// asked for. --list prints one summary line per segment instead.
+
+#include "DataProcessor/formatLayout.h"
+#include "backend/columnLog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Print value i of a decoded column using the field's layout type
+static void printValue(const DataFormat::FieldInfo& f, const uint8_t* column, size_t i) {
+    const uint8_t* at = column + i * f.width;
+    switch (f.type) {
+        case DataFormat::FieldType::Bool:
+        case DataFormat::FieldType::Uint8:
+            printf("%u", (unsigned)at[0]);
+            break;
+        case DataFormat::FieldType::Uint16: {
+            uint16_t v;
+            memcpy(&v, at, sizeof(v));
+            printf("%u", (unsigned)v);
+            break;
+        }
+        case DataFormat::FieldType::Uint64: {
+            uint64_t v;
+            memcpy(&v, at, sizeof(v));
+            printf("%llu", (unsigned long long)v);
+            break;
+        }
+        case DataFormat::FieldType::Float: {
+            float v;
+            memcpy(&v, at, sizeof(v));
+            printf("%g", (double)v);
+            break;
+        }
+        case DataFormat::FieldType::Double: {
+            double v;
+            memcpy(&v, at, sizeof(v));
+            printf("%g", v);
+            break;
+        }
+        case DataFormat::FieldType::Char:
+            printf("%c", (char)at[0]);
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    std::vector<int> fields;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            list = true;
+        } else if (arg == "--fields" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t pos = 0;
+            while (pos <= spec.size()) {
+                size_t comma = spec.find(',', pos);
+                std::string name = spec.substr(pos, comma == std::string::npos
+                                                        ? std::string::npos : comma - pos);
+                int index = DataFormat::fieldIndex(name.c_str());
+                if (index < 0) {
+                    fprintf(stderr, "unknown field '%s'\n", name.c_str());
+                    return 1;
+                }
+                fields.push_back(index);
+                if (comma == std::string::npos) {
+                    break;
+                }
+                pos = comma + 1;
+            }
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || (!list && fields.empty())) {
+        fprintf(stderr, "usage: %s <segment.bcol>... --fields <name>[,<name>...] | --list\n",
+                argv[0]);
+        return 1;
+    }
+
+    constexpr int tsIndex = DataFormat::fieldIndex("tstamp_unix");
+    static_assert(tsIndex >= 0, "format has no tstamp_unix field");
+
+    if (!list) {
+        printf("tstamp_unix");
+        for (int f : fields) {
+            printf(",%s", DataFormat::FIELDS[f].name);
+        }
+        printf("\n");
+    }
+
+    for (const std::string& path : paths) {
+        ColumnLogReader reader;
+        if (!reader.open(path)) {
+            fprintf(stderr, "%s: unreadable, truncated or wrong layout hash\n", path.c_str());
+            continue;
+        }
+        if (list) {
+            printf("%s: %u rows, layout %08x\n", path.c_str(),
+                   reader.rows(), reader.segmentHeader().layoutHash);
+            continue;
+        }
+
+        std::vector<uint8_t> tsColumn;
+        std::vector<std::vector<uint8_t>> columns(fields.size());
+        bool ok = reader.column(tsIndex, tsColumn);
+        for (size_t f = 0; ok && f < fields.size(); f++) {
+            ok = reader.column(fields[f], columns[f]);
+        }
+        if (!ok) {
+            fprintf(stderr, "%s: corrupt column, segment skipped\n", path.c_str());
+            continue;
+        }
+
+        for (size_t i = 0; i < reader.rows(); i++) {
+            printValue(DataFormat::FIELDS[tsIndex], tsColumn.data(), i);
+            for (size_t f = 0; f < fields.size(); f++) {
+                printf(",");
+                printValue(DataFormat::FIELDS[fields[f]], columns[f].data(), i);
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
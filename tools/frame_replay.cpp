@@ -0,0 +1,202 @@
+//
+// High-rate frame replay / load generator for the ethernet ingest path.
+// Streams v2-framed frames over TCP to a running DataFetcher at a
+// configurable multiple of real time with microsecond pacing, replacing the
+// python ethernet_sim which tops out at a few hundred frames per second.
+//
+//   frame_replay [host] [port] [rate_fps] [multiplier] [log-file]
+//
+// With a log file, the recorded frames are replayed in order (looping);
+// both the v2 framing and legacy <bsr>-tagged logs are understood. Without
+// one, deterministic synthetic frames are generated from the compiled-in
+// format layout. Achieved rate and socket backpressure (time blocked in
+// send, partial writes) are reported once a second.
+//
+
+#include "DataProcessor/formatLayout.h"
+#include "backend/frameCodec.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <netdb.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+static uint64_t nowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Wrap a raw frame in the v2 wire framing once, up front.
+static std::vector<uint8_t> frameRecord(const uint8_t* data, size_t len) {
+    std::vector<uint8_t> out(FrameCodec::HEADER_BYTES + len);
+    FrameCodec::writeHeader(out.data(), (uint32_t)len, DataFormat::layoutHash(),
+                            FrameCodec::checksum(data, len));
+    memcpy(out.data() + FrameCodec::HEADER_BYTES, data, len);
+    return out;
+}
+
+// Extract payloads from a recorded log; the first bytes tell v2 framing
+// from a legacy <bsr>-tagged stream, same as FramingParser.
+static std::vector<std::vector<uint8_t>> loadLog(const std::string& path) {
+    std::vector<std::vector<uint8_t>> frames;
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> blob((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+
+    if (blob.size() >= FrameCodec::MAGIC_LEN &&
+        memcmp(blob.data(), FrameCodec::MAGIC, FrameCodec::MAGIC_LEN) == 0) {
+        size_t pos = 0;
+        FrameCodec::Header hdr;
+        std::vector<uint8_t> inflated(DataFormat::FRAME_SIZE);
+        while (pos + FrameCodec::HEADER_BYTES <= blob.size() &&
+               FrameCodec::readHeader((const uint8_t*)blob.data() + pos, hdr) &&
+               pos + FrameCodec::HEADER_BYTES + hdr.length <= blob.size()) {
+            const uint8_t* payload = (const uint8_t*)blob.data() + pos + FrameCodec::HEADER_BYTES;
+            if (FrameCodec::checksum(payload, hdr.length) == hdr.crc) {
+                if (hdr.compressed) {
+                    // replay uncompressed regardless of how the log was
+                    // stored; the ingest path is what's being exercised
+                    size_t n = FrameCodec::decompressPayload(payload, hdr.length,
+                                                             inflated.data(), inflated.size());
+                    if (n != 0) {
+                        frames.push_back(frameRecord(inflated.data(), n));
+                    }
+                } else {
+                    frames.push_back(frameRecord(payload, hdr.length));
+                }
+            }
+            pos += FrameCodec::HEADER_BYTES + hdr.length;
+        }
+        return frames;
+    }
+
+    const std::string start = "<bsr>";
+    const std::string end = "</bsr>";
+    size_t pos = 0;
+    while (true) {
+        size_t s = std::string_view(blob.data(), blob.size()).find(start, pos);
+        if (s == std::string_view::npos) {
+            break;
+        }
+        size_t e = std::string_view(blob.data(), blob.size()).find(end, s);
+        if (e == std::string_view::npos) {
+            break;
+        }
+        const uint8_t* payload = (const uint8_t*)blob.data() + s + start.size();
+        frames.push_back(frameRecord(payload, e - s - start.size()));
+        pos = e + end.size();
+    }
+    return frames;
+}
+
+static std::vector<std::vector<uint8_t>> syntheticFrames() {
+    // a handful of distinct frames so the receiver sees changing data
+    std::mt19937 rng(42);
+    std::vector<std::vector<uint8_t>> frames;
+    for (int k = 0; k < 64; k++) {
+        std::vector<uint8_t> frame(DataFormat::FRAME_SIZE);
+        for (auto& b : frame) {
+            b = (uint8_t)rng();
+        }
+        for (const auto& f : DataFormat::FIELDS) {
+            if (f.type == DataFormat::FieldType::Bool) {
+                frame[f.offset] &= 1;
+            }
+        }
+        frames.push_back(frameRecord(frame.data(), frame.size()));
+    }
+    return frames;
+}
+
+int main(int argc, char** argv) {
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? atoi(argv[2]) : 4005;
+    double rate = argc > 3 ? atof(argv[3]) : 50.0;
+    double multiplier = argc > 4 ? atof(argv[4]) : 1.0;
+    std::string logFile = argc > 5 ? argv[5] : "";
+
+    std::vector<std::vector<uint8_t>> frames =
+        logFile.empty() ? syntheticFrames() : loadLog(logFile);
+    if (frames.empty()) {
+        fprintf(stderr, "no frames to send (log empty or unreadable)\n");
+        return 1;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0 || !res) {
+        fprintf(stderr, "cannot resolve %s\n", host.c_str());
+        return 1;
+    }
+    int fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0 || ::connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        fprintf(stderr, "cannot connect to %s:%d\n", host.c_str(), port);
+        freeaddrinfo(res);
+        return 1;
+    }
+    freeaddrinfo(res);
+
+    double fps = rate * multiplier;
+    uint64_t intervalUs = (uint64_t)(1e6 / fps);
+    printf("replaying %zu frame(s) at %.0f fps (%.1fx of %.0f) to %s:%d\n",
+           frames.size(), fps, multiplier, rate, host.c_str(), port);
+
+    uint64_t next = nowUs();
+    uint64_t lastReport = next;
+    uint64_t sent = 0, sentAtReport = 0;
+    uint64_t blockedUs = 0, blockedAtReport = 0;
+    uint64_t partials = 0, behind = 0;
+    size_t index = 0;
+
+    while (true) {
+        const std::vector<uint8_t>& frame = frames[index];
+        index = (index + 1) % frames.size();
+
+        uint64_t before = nowUs();
+        size_t off = 0;
+        while (off < frame.size()) {
+            ssize_t n = ::send(fd, frame.data() + off, frame.size() - off, MSG_NOSIGNAL);
+            if (n < 0) {
+                fprintf(stderr, "send failed after %llu frames\n", (unsigned long long)sent);
+                close(fd);
+                return 1;
+            }
+            if ((size_t)n < frame.size() - off) {
+                partials++; // kernel buffer full: backpressure
+            }
+            off += (size_t)n;
+        }
+        uint64_t after = nowUs();
+        blockedUs += after - before;
+        sent++;
+
+        // microsecond pacing against an absolute schedule, so late frames
+        // are caught up rather than accumulating drift
+        next += intervalUs;
+        if (after < next) {
+            usleep((useconds_t)(next - after));
+        } else {
+            behind++;
+        }
+
+        if (after - lastReport >= 1000000) {
+            printf("sent %llu fps=%.0f sendtime=%.1fms partial=%llu behind=%llu\n",
+                   (unsigned long long)sent,
+                   (double)(sent - sentAtReport) * 1e6 / (after - lastReport),
+                   (double)(blockedUs - blockedAtReport) / 1000.0,
+                   (unsigned long long)partials, (unsigned long long)behind);
+            lastReport = after;
+            sentAtReport = sent;
+            blockedAtReport = blockedUs;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Generate DataProcessor/formatLayout.h from sc1-data-format/format.json.
+
+The telemetry packet layout (field order, widths and types) is fixed at build
+time, so instead of parsing format.json with rapidjson on every startup and
+driving unpack() off string vectors, we emit a constexpr field table
+(offset, width, type tag, FNV-1a name hash) that the hot path can iterate
+as a plain POD array.
+
+Usage: gen_format_layout.py <format.json> <output-header>
+"""
+
+import json
+import sys
+
+TYPE_TAGS = {
+    'bool': 'Bool',
+    'uint8': 'Uint8',
+    'uint16': 'Uint16',
+    'uint64': 'Uint64',
+    'float': 'Float',
+    'double': 'Double',
+    'char': 'Char',
+}
+
+
+def fnv1a(name: str) -> int:
+    """32-bit FNV-1a, must match DataFormat::fnv1a in the generated header."""
+    h = 0x811C9DC5
+    for c in name.encode('ascii'):
+        h = ((h ^ c) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    with open(sys.argv[1], 'r') as f:
+        data_format = json.load(f)
+
+    fields = []
+    offset = 0
+    for name, spec in data_format.items():
+        width, type_name = spec[0], spec[1]
+        if type_name not in TYPE_TAGS:
+            print(f'unknown type "{type_name}" for field "{name}"', file=sys.stderr)
+            return 1
+        fields.append((name, offset, width, TYPE_TAGS[type_name]))
+        offset += width
+
+    lines = []
+    out = lines.append
+    out('// Generated by tools/gen_format_layout.py from sc1-data-format/format.json')
+    out('// DO NOT EDIT BY HAND - rerun the generator after changing the data format.')
+    out('')
+    out('#ifndef DATAPROCESSOR_FORMATLAYOUT_H')
+    out('#define DATAPROCESSOR_FORMATLAYOUT_H')
+    out('')
+    out('#include <cstdint>')
+    out('')
+    out('namespace DataFormat {')
+    out('')
+    out('enum class FieldType : uint8_t {')
+    out('    Bool,')
+    out('    Uint8,')
+    out('    Uint16,')
+    out('    Uint64,')
+    out('    Float,')
+    out('    Double,')
+    out('    Char')
+    out('};')
+    out('')
+    out('struct FieldInfo {')
+    out('    const char* name;')
+    out('    uint32_t nameHash;  // FNV-1a of name, see fnv1a() below')
+    out('    uint16_t offset;    // byte offset of the field within a frame')
+    out('    uint8_t width;      // field width in bytes')
+    out('    FieldType type;')
+    out('};')
+    out('')
+    out('// 32-bit FNV-1a; constexpr so field lookups by name resolve at compile time.')
+    out('constexpr uint32_t fnv1a(const char* s) {')
+    out('    uint32_t h = 0x811C9DC5u;')
+    out('    while (*s) {')
+    out('        h ^= static_cast<uint8_t>(*s++);')
+    out('        h *= 0x01000193u;')
+    out('    }')
+    out('    return h;')
+    out('}')
+    out('')
+    out(f'inline constexpr int FIELD_COUNT = {len(fields)};')
+    out(f'inline constexpr int FRAME_SIZE = {offset};')
+    out('')
+    out('inline constexpr FieldInfo FIELDS[FIELD_COUNT] = {')
+    for name, off, width, tag in fields:
+        out(f'    {{"{name}", 0x{fnv1a(name):08X}u, {off}, {width}, FieldType::{tag}}},')
+    out('};')
+    out('')
+    out('// Index of a field by name, or -1 if the format does not contain it.')
+    out('constexpr int fieldIndex(const char* name) {')
+    out('    const uint32_t h = fnv1a(name);')
+    out('    for (int i = 0; i < FIELD_COUNT; i++) {')
+    out('        if (FIELDS[i].nameHash == h) {')
+    out('            return i;')
+    out('        }')
+    out('    }')
+    out('    return -1;')
+    out('}')
+    out('')
+    out('// Byte offset of a field by name, or -1 if the format does not contain it.')
+    out('constexpr int fieldOffset(const char* name) {')
+    out('    const int i = fieldIndex(name);')
+    out('    return i < 0 ? -1 : FIELDS[i].offset;')
+    out('}')
+    out('')
+    out('// Hash of the whole layout (names, offsets, widths). Both ends of a link can')
+    out('// compare this to check they were generated from the same format.json.')
+    out('constexpr uint32_t layoutHash() {')
+    out('    uint32_t h = 0x811C9DC5u;')
+    out('    for (int i = 0; i < FIELD_COUNT; i++) {')
+    out('        h = (h ^ FIELDS[i].nameHash) * 0x01000193u;')
+    out('        h = (h ^ FIELDS[i].offset) * 0x01000193u;')
+    out('        h = (h ^ FIELDS[i].width) * 0x01000193u;')
+    out('    }')
+    out('    return h;')
+    out('}')
+    out('')
+    out('} // namespace DataFormat')
+    out('')
+    out('#endif // DATAPROCESSOR_FORMATLAYOUT_H')
+    out('')
+
+    with open(sys.argv[2], 'w') as f:
+        f.write('\n'.join(lines))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())